@@ -0,0 +1,197 @@
+#include "decode.hpp"
+
+#include <error.hpp>
+
+#include <utility>
+
+namespace {
+
+const JsonType& require(JsonSlot slot, auto JsonType::* handler,
+    std::string_view what)
+{
+    if (!(slot.type->*handler)) {
+        throw e::Error{} << "unexpected JSON " << what;
+    }
+    return *slot.type;
+}
+
+} // namespace
+
+void decodeJson(const nlohmann::json& json, JsonSlot slot)
+{
+    if (!slot.type) {
+        return;
+    }
+
+    switch (json.type()) {
+        case nlohmann::json::value_t::object:
+        {
+            require(slot, &JsonType::key, "object");
+            auto seen = uint64_t{0};
+            for (const auto& [key, value] :
+                    json.get_ref<const nlohmann::json::object_t&>()) {
+                decodeJson(value, slot.type->key(slot.target, key, seen));
+            }
+            slot.type->check(seen);
+            break;
+        }
+
+        case nlohmann::json::value_t::array:
+            require(slot, &JsonType::element, "array");
+            slot.type->reserve(slot.target, json.size());
+            for (const auto& value : json) {
+                decodeJson(value, slot.type->element(slot.target));
+            }
+            break;
+
+        case nlohmann::json::value_t::string:
+            require(slot, &JsonType::string, "string").string(
+                slot.target, json.get_ref<const nlohmann::json::string_t&>());
+            break;
+
+        case nlohmann::json::value_t::boolean:
+            require(slot, &JsonType::boolean, "boolean").boolean(
+                slot.target, json.get<bool>());
+            break;
+
+        case nlohmann::json::value_t::number_integer:
+        case nlohmann::json::value_t::number_unsigned:
+        case nlohmann::json::value_t::number_float:
+            require(slot, &JsonType::number, "number").number(
+                slot.target, json.get<double>());
+            break;
+
+        case nlohmann::json::value_t::null:
+        case nlohmann::json::value_t::binary:
+        case nlohmann::json::value_t::discarded:
+            break;
+    }
+}
+
+JsonDecoder::JsonDecoder(JsonSlot root)
+    : _root(root)
+{ }
+
+bool JsonDecoder::null()
+{
+    next();
+    return true;
+}
+
+bool JsonDecoder::boolean(bool value)
+{
+    if (auto slot = next(); slot.type) {
+        require(slot, &JsonType::boolean, "boolean").boolean(
+            slot.target, value);
+    }
+    return true;
+}
+
+bool JsonDecoder::number_integer(number_integer_t value)
+{
+    number(static_cast<double>(value));
+    return true;
+}
+
+bool JsonDecoder::number_unsigned(number_unsigned_t value)
+{
+    number(static_cast<double>(value));
+    return true;
+}
+
+bool JsonDecoder::number_float(number_float_t value, const string_t&)
+{
+    number(value);
+    return true;
+}
+
+bool JsonDecoder::string(string_t& value)
+{
+    if (auto slot = next(); slot.type) {
+        require(slot, &JsonType::string, "string").string(slot.target, value);
+    }
+    return true;
+}
+
+bool JsonDecoder::binary(binary_t&)
+{
+    next();
+    return true;
+}
+
+bool JsonDecoder::start_object(std::size_t)
+{
+    auto slot = next();
+    if (slot.type) {
+        require(slot, &JsonType::key, "object");
+    }
+    _containers.push_back({.slot = slot, .isArray = false, .seen = 0});
+    return true;
+}
+
+bool JsonDecoder::key(string_t& value)
+{
+    auto& container = _containers.back();
+    const auto& slot = container.slot;
+    _value = slot.type ?
+        slot.type->key(slot.target, value, container.seen) : JsonSlot{};
+    return true;
+}
+
+bool JsonDecoder::end_object()
+{
+    const auto& container = _containers.back();
+    if (container.slot.type) {
+        container.slot.type->check(container.seen);
+    }
+    _containers.pop_back();
+    return true;
+}
+
+bool JsonDecoder::start_array(std::size_t elements)
+{
+    auto slot = next();
+    if (slot.type) {
+        require(slot, &JsonType::element, "array");
+        if (elements != static_cast<std::size_t>(-1)) {
+            slot.type->reserve(slot.target, elements);
+        }
+    }
+    _containers.push_back({.slot = slot, .isArray = true, .seen = 0});
+    return true;
+}
+
+bool JsonDecoder::end_array()
+{
+    _containers.pop_back();
+    return true;
+}
+
+bool JsonDecoder::parse_error(
+    std::size_t, const std::string&, const nlohmann::detail::exception& ex)
+{
+    throw e::Error{} << ex.what();
+}
+
+// the slot of the value that starts now
+JsonSlot JsonDecoder::next()
+{
+    if (_containers.empty()) {
+        return std::exchange(_root, {});
+    }
+    const auto& container = _containers.back();
+    if (!container.isArray) {
+        return std::exchange(_value, {});
+    }
+    if (!container.slot.type) {
+        return {};
+    }
+    return container.slot.type->element(container.slot.target);
+}
+
+void JsonDecoder::number(double value)
+{
+    if (auto slot = next(); slot.type) {
+        require(slot, &JsonType::number, "number").number(slot.target, value);
+    }
+}
\ No newline at end of file
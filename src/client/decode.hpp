@@ -0,0 +1,352 @@
+#pragma once
+
+#include "enum_names.hpp"
+#include "key_table.hpp"
+
+#include <error.hpp>
+
+#include <http/json_stream.hpp>
+#include <http/pages.hpp>
+
+#include <nlohmann/json.hpp>
+
+#include <array>
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Typed JSON decoding in one forward pass, from a DOM or from a token
+// stream. A struct is decoded from a JSON object by declaring its fields
+// next to it, found by argument-dependent lookup:
+//
+//     constexpr auto jsonFields(std::type_identity<Waypoint>)
+//     {
+//         return std::tuple{
+//             JsonField{"symbol", &Waypoint::symbol},
+//             JsonField{"x", [] (Waypoint& w) -> auto& { return w.point.x; }},
+//         };
+//     }
+//
+// Keys are looked up in a KeyTable built from the field names; values of
+// unknown keys are skipped without being decoded. A field missing from the
+// object is an error unless it is declared JsonPresence::Optional, in
+// which case it keeps its default. Strings decode into std::string, named
+// enums and types constructible from a string_view, numbers into
+// arithmetic types, arrays into std::vector.
+
+enum class JsonPresence {
+    Required,
+    Optional,
+};
+
+template <class Access>
+struct JsonField {
+    std::string_view name;
+    Access access;
+    JsonPresence presence = JsonPresence::Required;
+
+    template <class T>
+    constexpr auto& of(T& object) const
+    {
+        if constexpr (std::is_member_object_pointer_v<Access>) {
+            return object.*access;
+        } else {
+            return access(object);
+        }
+    }
+};
+
+template <class Access>
+JsonField(const char*, Access) -> JsonField<Access>;
+
+template <class Access>
+JsonField(const char*, Access, JsonPresence) -> JsonField<Access>;
+
+template <class T>
+concept JsonObject = requires
+{
+    jsonFields(std::type_identity<T>{});
+};
+
+struct JsonType;
+
+// Where a JSON value goes: a target object and how to decode into it. A
+// slot without a type swallows the value.
+struct JsonSlot {
+    void* target = nullptr;
+    const JsonType* type = nullptr;
+};
+
+// An object's keys are matched with key(), which marks the field it found
+// in `seen`; once the object ends, check() throws if a required field was
+// never seen.
+struct JsonType {
+    void (*string)(void* target, std::string_view value) = nullptr;
+    void (*number)(void* target, double value) = nullptr;
+    void (*boolean)(void* target, bool value) = nullptr;
+    JsonSlot (*key)(void* target, std::string_view key, uint64_t& seen) =
+        nullptr;
+    void (*check)(uint64_t seen) = nullptr;
+    JsonSlot (*element)(void* target) = nullptr;
+    void (*reserve)(void* target, size_t size) = nullptr;
+};
+
+template <class T>
+struct IsVector : std::false_type { };
+
+template <class T>
+struct IsVector<std::vector<T>> : std::true_type { };
+
+template <class T>
+constexpr JsonType makeJsonType();
+
+template <class T>
+constexpr auto jsonTypeOf = makeJsonType<T>();
+
+template <class T>
+JsonSlot jsonSlot(T& value)
+{
+    return {&value, &jsonTypeOf<T>};
+}
+
+template <JsonObject T>
+struct JsonFieldTable {
+    static constexpr auto fields = jsonFields(std::type_identity<T>{});
+    static constexpr auto size = std::tuple_size_v<decltype(fields)>;
+    static_assert(size <= 64, "seen fields are tracked in 64 bits");
+
+    static constexpr auto keys =
+        [] <size_t... I> (std::index_sequence<I...>) {
+            return KeyTable<size>{{std::get<I>(fields).name...}};
+        }(std::make_index_sequence<size>{});
+
+    using Get = JsonSlot (*)(T&);
+    static constexpr auto slots =
+        [] <size_t... I> (std::index_sequence<I...>) {
+            return std::array<Get, size>{
+                [] (T& object) {
+                    return jsonSlot(std::get<I>(fields).of(object));
+                }...
+            };
+        }(std::make_index_sequence<size>{});
+
+    static constexpr auto required =
+        [] <size_t... I> (std::index_sequence<I...>) {
+            return ((std::get<I>(fields).presence == JsonPresence::Required ?
+                uint64_t{1} << I : uint64_t{0}) | ... | uint64_t{0});
+        }(std::make_index_sequence<size>{});
+};
+
+template <JsonObject T>
+JsonSlot jsonKey(T& object, std::string_view key, uint64_t& seen)
+{
+    using Table = JsonFieldTable<T>;
+    if (auto index = Table::keys.find(key)) {
+        seen |= uint64_t{1} << *index;
+        return Table::slots[*index](object);
+    }
+    return {};
+}
+
+template <JsonObject T>
+void jsonCheck(uint64_t seen)
+{
+    using Table = JsonFieldTable<T>;
+    if (auto missing = Table::required & ~seen) {
+        throw e::Error{} << "missing JSON field \"" <<
+            Table::keys[static_cast<size_t>(std::countr_zero(missing))] <<
+            "\"";
+    }
+}
+
+template <class T>
+constexpr JsonType makeJsonType()
+{
+    auto type = JsonType{};
+
+    if constexpr (std::same_as<T, std::string>) {
+        type.string = [] (void* target, std::string_view value) {
+            static_cast<T*>(target)->assign(value);
+        };
+    } else if constexpr (NamedEnum<T>) {
+        type.string = [] (void* target, std::string_view value) {
+            *static_cast<T*>(target) = fromString<T>(value);
+        };
+    } else if constexpr (std::constructible_from<T, std::string_view>) {
+        type.string = [] (void* target, std::string_view value) {
+            *static_cast<T*>(target) = T{value};
+        };
+    }
+
+    if constexpr (std::same_as<T, bool>) {
+        type.boolean = [] (void* target, bool value) {
+            *static_cast<T*>(target) = value;
+        };
+    } else if constexpr (std::is_arithmetic_v<T>) {
+        type.number = [] (void* target, double value) {
+            *static_cast<T*>(target) = static_cast<T>(value);
+        };
+    }
+
+    if constexpr (JsonObject<T>) {
+        type.key = [] (void* target, std::string_view key, uint64_t& seen) {
+            return jsonKey(*static_cast<T*>(target), key, seen);
+        };
+        type.check = jsonCheck<T>;
+    }
+
+    if constexpr (IsVector<T>::value) {
+        type.element = [] (void* target) {
+            return jsonSlot(static_cast<T*>(target)->emplace_back());
+        };
+        type.reserve = [] (void* target, size_t size) {
+            static_cast<T*>(target)->reserve(size);
+        };
+    }
+
+    return type;
+}
+
+// decodes a DOM into `slot`, reserving vectors to the size of their arrays
+void decodeJson(const nlohmann::json& json, JsonSlot slot);
+
+// decodes the events of a SAX parser such as http::JsonStream into `slot`
+class JsonDecoder : public nlohmann::json::json_sax_t {
+public:
+    explicit JsonDecoder(JsonSlot root);
+
+    bool null() override;
+    bool boolean(bool value) override;
+    bool number_integer(number_integer_t value) override;
+    bool number_unsigned(number_unsigned_t value) override;
+    bool number_float(number_float_t value, const string_t& string) override;
+    bool string(string_t& value) override;
+    bool binary(binary_t& value) override;
+    bool start_object(std::size_t elements) override;
+    bool key(string_t& value) override;
+    bool end_object() override;
+    bool start_array(std::size_t elements) override;
+    bool end_array() override;
+    bool parse_error(
+        std::size_t position,
+        const std::string& lastToken,
+        const nlohmann::detail::exception& ex) override;
+
+private:
+    struct Container {
+        JsonSlot slot;
+        bool isArray = false;
+        uint64_t seen = 0;
+    };
+
+    JsonSlot next();
+    void number(double value);
+
+    JsonSlot _root;
+    JsonSlot _value;
+    std::vector<Container> _containers;
+};
+
+template <class T>
+T decodeJson(const nlohmann::json& json)
+{
+    auto value = T{};
+    decodeJson(json, jsonSlot(value));
+    return value;
+}
+
+template <class T>
+T parseJson(std::string_view body)
+{
+    auto value = T{};
+    auto decoder = JsonDecoder{jsonSlot(value)};
+    auto stream = http::JsonStream{decoder};
+    stream.write(body);
+    stream.finish();
+    return value;
+}
+
+struct JsonPageMeta {
+    size_t total = 0;
+};
+
+constexpr auto jsonFields(std::type_identity<JsonPageMeta>)
+{
+    return std::tuple{
+        JsonField{"total", &JsonPageMeta::total},
+    };
+}
+
+template <class T>
+struct JsonPage {
+    std::vector<T> data;
+    JsonPageMeta meta;
+};
+
+template <class T>
+constexpr auto jsonFields(std::type_identity<JsonPage<T>>)
+{
+    return std::tuple{
+        JsonField{"data", &JsonPage<T>::data},
+        JsonField{"meta", &JsonPage<T>::meta},
+    };
+}
+
+// an http::PageStream decoder for a list endpoint
+template <class T>
+http::Page<T> decodePage(std::string_view body)
+{
+    auto page = parseJson<JsonPage<T>>(body);
+    return {.items = std::move(page.data), .total = page.meta.total};
+}
+
+// decodes a page of a list endpoint while it downloads
+template <class T>
+class PageDecoder : public http::PageParser<T> {
+public:
+    void write(std::string_view chunk) override
+    {
+        _state->stream.write(chunk);
+    }
+
+    void finish() override
+    {
+        _state->stream.finish();
+    }
+
+    bool rewind() override
+    {
+        _state = std::make_unique<State>();
+        return true;
+    }
+
+    http::Page<T> page() override
+    {
+        auto& page = _state->page;
+        return {.items = std::move(page.data), .total = page.meta.total};
+    }
+
+private:
+    struct State {
+        JsonPage<T> page;
+        JsonDecoder decoder{jsonSlot(page)};
+        http::JsonStream stream{decoder};
+    };
+
+    std::unique_ptr<State> _state = std::make_unique<State>();
+};
+
+// an http::PageStream parser factory for a list endpoint
+template <class T>
+std::unique_ptr<http::PageParser<T>> pageDecoder()
+{
+    return std::make_unique<PageDecoder<T>>();
+}
\ No newline at end of file
@@ -0,0 +1,168 @@
+#include "decode.hpp"
+#include "protocol.hpp"
+
+#include <arg.hpp>
+
+#include <error.hpp>
+
+#include <http.hpp>
+#include <http/cassette.hpp>
+
+#include <nlohmann/json.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Times the ways a page of /systems can be decoded: through a DOM read field
+// by field, as the client did before decode.hpp, through a DOM and the field
+// tables, in one pass over the whole body, and streamed in chunks as
+// PageStream does.
+// The page comes from a file, or from a cassette the client recorded with
+// SPACE_TRADERS_RECORD.
+
+namespace {
+
+std::string readFile(const std::string& path)
+{
+    auto input = std::ifstream{path, std::ios::binary};
+    if (!input) {
+        throw e::Error{} << "cannot open " << path;
+    }
+    return {std::istreambuf_iterator<char>{input}, {}};
+}
+
+std::string replayPage(const std::string& path)
+{
+    auto init = http::Init{};
+    auto cassette = http::Cassette{path, http::Cassette::Mode::Replay};
+    auto session = http::Session{};
+    session.baseUrl("https://api.spacetraders.io/v2");
+    session.useCassette(cassette);
+
+    // the first request World makes
+    auto response = session(http::Request{
+        .url = "systems",
+        .params = {{"page", "1"}, {"limit", "20"}},
+    });
+    if (response.code >= 400) {
+        throw e::Error{} << "recorded HTTP " << response.code << ": " <<
+            response.contents;
+    }
+    return std::move(response.contents);
+}
+
+const std::string& text(const nlohmann::json& j)
+{
+    return j.get_ref<const std::string&>();
+}
+
+Waypoint waypointJson(const nlohmann::json& j)
+{
+    auto waypoint = Waypoint{
+        .symbol = WaypointName{text(j["symbol"])},
+        .type = fromString<WaypointType>(text(j["type"])),
+        .point = {j["x"].get<float>(), j["y"].get<float>()},
+    };
+    for (const auto& orbital : j["orbitals"]) {
+        waypoint.orbitals.emplace_back(text(orbital["symbol"]));
+    }
+    return waypoint;
+}
+
+System systemJson(const nlohmann::json& j)
+{
+    auto system = System{
+        .symbol = SystemName{text(j["symbol"])},
+        .sectorSymbol = SectorName{text(j["sectorSymbol"])},
+        .type = fromString<SystemType>(text(j["type"])),
+        .point = {j["x"].get<float>(), j["y"].get<float>()},
+    };
+    for (const auto& waypoint : j["waypoints"]) {
+        system.waypoints.push_back(waypointJson(waypoint));
+    }
+    return system;
+}
+
+template <class Decode>
+void run(std::string_view name, int rounds, Decode decode)
+{
+    auto best = std::chrono::steady_clock::duration::max();
+    size_t systems = 0;
+    for (int i = 0; i < rounds; i++) {
+        auto start = std::chrono::steady_clock::now();
+        systems = decode().size();
+        best = std::min(best, std::chrono::steady_clock::now() - start);
+    }
+
+    std::cout << name << ": " <<
+        std::chrono::duration<double, std::milli>{best}.count() <<
+        " ms, " << systems << " systems\n";
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) try
+{
+    auto file = arg::option<std::string>()
+        .keys("--file")
+        .metavar("PATH")
+        .help("a /systems page, as JSON");
+    auto replay = arg::option<std::string>()
+        .keys("--replay")
+        .metavar("PATH")
+        .help("a cassette to take the first /systems page from");
+    auto rounds = arg::option<int>()
+        .keys("--rounds")
+        .help("times each decoder runs; the best time is reported");
+    arg::helpKeys("-h", "--help");
+    arg::parse(argc, argv);
+
+    auto body = std::string{};
+    if (file.isSet()) {
+        body = readFile(*file);
+    } else if (replay.isSet()) {
+        body = replayPage(*replay);
+    } else {
+        throw e::Error{} << "one of --file and --replay is needed";
+    }
+    int roundCount = rounds.isSet() ? *rounds : 100;
+    std::cout << body.size() << " bytes\n";
+
+    run("DOM, field by field", roundCount, [&body] {
+        auto json = nlohmann::json::parse(body);
+        auto systems = std::vector<System>{};
+        for (const auto& system : json["data"]) {
+            systems.push_back(systemJson(system));
+        }
+        return systems;
+    });
+    run("DOM + decodeJson", roundCount, [&body] {
+        return decodeJson<JsonPage<System>>(nlohmann::json::parse(body)).data;
+    });
+    run("parseJson", roundCount, [&body] {
+        return parseJson<JsonPage<System>>(body).data;
+    });
+    run("PageDecoder, 16 KiB chunks", roundCount, [&body] {
+        auto decoder = PageDecoder<System>{};
+        auto rest = std::string_view{body};
+        while (!rest.empty()) {
+            auto chunk = rest.substr(0, 16 * 1024);
+            decoder.write(chunk);
+            rest.remove_prefix(chunk.size());
+        }
+        decoder.finish();
+        return decoder.page().items;
+    });
+    return EXIT_SUCCESS;
+} catch (...) {
+    e::handleError();
+    return EXIT_FAILURE;
+}
\ No newline at end of file
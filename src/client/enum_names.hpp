@@ -0,0 +1,116 @@
+#pragma once
+
+#include "key_table.hpp"
+
+#include <error.hpp>
+
+#include <array>
+#include <cstddef>
+#include <istream>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <typeinfo>
+#include <utility>
+
+// An enum gets string conversions by declaring its names next to it, found
+// by argument-dependent lookup:
+//
+//     constexpr auto enumNames(Color)
+//     {
+//         using enum Color;
+//         return std::to_array<EnumName<Color>>({
+//             {Red, "RED"},
+//             {Green, "GREEN"},
+//         });
+//     }
+//
+// The enumerators must be exactly 0..N-1, each named once.
+
+template <class T>
+struct EnumName {
+    T value;
+    std::string_view name;
+};
+
+template <class T>
+concept NamedEnum = std::is_scoped_enum_v<T> && requires (T value)
+{
+    enumNames(value);
+};
+
+// Name lookup in both directions, built at compile time: values index an
+// array of names, and names are found through a KeyTable.
+template <class T, size_t N>
+class NameTable {
+public:
+    consteval explicit NameTable(const std::array<EnumName<T>, N>& names)
+        : _keys(byValue(names))
+    { }
+
+    constexpr std::string_view name(T value) const
+    {
+        auto index = static_cast<size_t>(std::to_underlying(value));
+        return index < N ? _keys[index] : std::string_view{};
+    }
+
+    constexpr std::optional<T> find(std::string_view name) const
+    {
+        if (auto index = _keys.find(name)) {
+            return static_cast<T>(*index);
+        }
+        return std::nullopt;
+    }
+
+private:
+    static consteval std::array<std::string_view, N> byValue(
+        const std::array<EnumName<T>, N>& names)
+    {
+        auto result = std::array<std::string_view, N>{};
+        for (const auto& [value, name] : names) {
+            auto index = static_cast<size_t>(std::to_underlying(value));
+            if (index >= N || !result[index].empty() || name.empty()) {
+                throw "enumerators must be 0..N-1, each with one name";
+            }
+            result[index] = name;
+        }
+        return result;
+    }
+
+    KeyTable<N> _keys;
+};
+
+template <NamedEnum T>
+constexpr auto nameTable = NameTable{enumNames(T{})};
+
+template <NamedEnum T>
+T fromString(std::string_view string)
+{
+    if (auto value = nameTable<T>.find(string)) {
+        return *value;
+    }
+    throw e::Error{} <<
+        "unknown name for " << typeid(T).name() << ": " << string;
+}
+
+template <NamedEnum T>
+std::ostream& operator<<(std::ostream& output, T value)
+{
+    if (auto name = nameTable<T>.name(value); !name.empty()) {
+        return output << name;
+    }
+    throw e::Error{} << "unknown value (" << std::to_underlying(value) <<
+        ") of " << typeid(T).name();
+}
+
+template <NamedEnum T>
+std::istream& operator>>(std::istream& input, T& value)
+{
+    auto string = std::string{};
+    if (input >> string) {
+        value = fromString<T>(string);
+    }
+    return input;
+}
\ No newline at end of file
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+
+// Perfect hash over a fixed set of keys, built at compile time: the seed is
+// searched for until every key hashes to a slot of its own, so a lookup
+// hashes once and compares a single candidate.
+template <size_t N>
+class KeyTable {
+public:
+    consteval explicit KeyTable(const std::array<std::string_view, N>& keys)
+        : _keys(keys)
+    {
+        static_assert(N < 255, "KeyTable slots are one byte");
+
+        for (size_t i = 0; i < N; i++) {
+            for (size_t j = 0; j < i; j++) {
+                if (_keys[i] == _keys[j]) {
+                    throw "duplicate key";
+                }
+            }
+        }
+
+        for (uint32_t seed = 0; seed < 1'000'000; seed++) {
+            if (tryBuild(seed)) {
+                return;
+            }
+        }
+        throw "no perfect hash found for the keys";
+    }
+
+    constexpr std::string_view operator[](size_t index) const
+    {
+        return _keys[index];
+    }
+
+    constexpr std::optional<size_t> find(std::string_view key) const
+    {
+        auto slot = _slots[hash(key, _seed) & (_slots.size() - 1)];
+        if (slot != 0 && _keys[slot - 1] == key) {
+            return slot - 1;
+        }
+        return std::nullopt;
+    }
+
+private:
+    static constexpr uint32_t hash(std::string_view key, uint32_t seed)
+    {
+        // FNV-1a
+        auto h = uint32_t{2166136261} ^ seed;
+        for (auto c : key) {
+            h = (h ^ static_cast<uint8_t>(c)) * 16777619u;
+        }
+        return h ^ (h >> 15);
+    }
+
+    constexpr bool tryBuild(uint32_t seed)
+    {
+        _slots = {};
+        for (size_t i = 0; i < N; i++) {
+            auto& slot = _slots[hash(_keys[i], seed) & (_slots.size() - 1)];
+            if (slot != 0) {
+                return false;
+            }
+            slot = static_cast<uint8_t>(i + 1);
+        }
+        _seed = seed;
+        return true;
+    }
+
+    std::array<std::string_view, N> _keys{};
+    // index + 1 of the key hashing to each slot, 0 for none
+    std::array<uint8_t, std::bit_ceil(2 * N)> _slots{};
+    uint32_t _seed = 0;
+};
\ No newline at end of file
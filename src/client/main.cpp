@@ -2,10 +2,33 @@
 #include "view.hpp"
 #include "world.hpp"
 
+#include <http/cassette.hpp>
+
 #include <sdl.hpp>
 
+#include <cstdlib>
 #include <exception>
 #include <iostream>
+#include <memory>
+
+namespace {
+
+// SPACE_TRADERS_RECORD=<path> records the session's responses to a file,
+// SPACE_TRADERS_REPLAY=<path> plays them back instead of going online
+std::unique_ptr<http::Cassette> cassetteFromEnvironment()
+{
+    if (const char* path = std::getenv("SPACE_TRADERS_RECORD")) {
+        return std::make_unique<http::Cassette>(
+            path, http::Cassette::Mode::Record);
+    }
+    if (const char* path = std::getenv("SPACE_TRADERS_REPLAY")) {
+        return std::make_unique<http::Cassette>(
+            path, http::Cassette::Mode::Replay);
+    }
+    return nullptr;
+}
+
+} // namespace
 
 int main(int, char*[]) try
 {
@@ -13,7 +36,8 @@ int main(int, char*[]) try
     auto imgInit = img::Init{IMG_INIT_PNG};
     auto ttfInit = ttf::Init{};
 
-    auto world = World{};
+    auto cassette = cassetteFromEnvironment();
+    auto world = World{cassette.get()};
     auto view = View{world};
 
     auto timer = FrameTimer{240};
@@ -22,6 +46,8 @@ int main(int, char*[]) try
             break;
         }
 
+        world.update();
+
         if (auto framesPassed = timer()) {
             // TODO: update world by delta
             view.update(framesPassed * timer.delta());
@@ -31,6 +57,7 @@ int main(int, char*[]) try
         timer.relax();
     }
 
+    world.metrics().dump(std::clog);
     return 0;
 } catch (...) {
     e::handleError();
@@ -1,52 +1,21 @@
 #pragma once
 
+#include "decode.hpp"
+#include "enum_names.hpp"
 #include "geometry.hpp"
+#include "symbols.hpp"
 
 #include <error.hpp>
 
 #include <nlohmann/json.hpp>
 
+#include <array>
 #include <string_view>
 #include <string>
+#include <tuple>
 #include <type_traits>
 #include <vector>
 
-template <class T>
-requires std::is_scoped_enum_v<T>
-T fromString(std::string_view string);
-
-class SectorName {
-public:
-    explicit SectorName(std::string name = "");
-
-    friend std::ostream& operator<<(std::ostream& output, const SectorName& sector);
-
-private:
-    std::string _sectorName;
-};
-
-class SystemName {
-public:
-    explicit SystemName(std::string_view name = "");
-
-    friend std::ostream& operator<<(std::ostream& output, const SystemName& system);
-
-private:
-    SectorName _sector;
-    std::string _systemPart;
-};
-
-class WaypointName {
-public:
-    explicit WaypointName(std::string_view name = "");
-
-    friend std::ostream& operator<<(std::ostream& output, const WaypointName& waypoint);
-
-private:
-    SystemName _system;
-    std::string _waypointPart;
-};
-
 enum class WaypointType {
     Asteroid,
     FuelStation,
@@ -56,17 +25,45 @@ enum class WaypointType {
     Planet,
 };
 
-extern template WaypointType fromString<WaypointType>(std::string_view string);
-std::ostream& operator<<(std::ostream& output, const WaypointType& waypointType);
-std::istream& operator>>(std::istream& input, WaypointType& waypointType);
+constexpr auto enumNames(WaypointType)
+{
+    using enum WaypointType;
+    return std::to_array<EnumName<WaypointType>>({
+        {Asteroid, "ASTEROID"},
+        {FuelStation, "FUEL_STATION"},
+        {GasGiant, "GAS_GIANT"},
+        {JumpGate, "JUMP_GATE"},
+        {Moon, "MOON"},
+        {Planet, "PLANET"},
+    });
+}
 
 struct Waypoint {
-    std::string symbol;
+    WaypointName symbol;
     WaypointType type;
     Point<float> point;
-    std::vector<std::string> orbitals;
+    std::vector<WaypointName> orbitals;
 };
 
+// orbitals are listed as objects holding just the symbol
+constexpr auto jsonFields(std::type_identity<WaypointName>)
+{
+    return std::tuple{
+        JsonField{"symbol", [] (WaypointName& name) -> auto& { return name; }},
+    };
+}
+
+constexpr auto jsonFields(std::type_identity<Waypoint>)
+{
+    return std::tuple{
+        JsonField{"symbol", &Waypoint::symbol},
+        JsonField{"type", &Waypoint::type},
+        JsonField{"x", [] (Waypoint& w) -> auto& { return w.point.x; }},
+        JsonField{"y", [] (Waypoint& w) -> auto& { return w.point.y; }},
+        JsonField{"orbitals", &Waypoint::orbitals},
+    };
+}
+
 enum class SystemType {
     BlueStar,
     OrangeStar,
@@ -75,50 +72,52 @@ enum class SystemType {
     YoungStar,
 };
 
-SystemType systemType(const std::string& string);
-std::ostream& operator<<(std::ostream& output, const SystemType& systemType);
-std::istream& operator>>(std::istream& input, SystemType& systemType);
+constexpr auto enumNames(SystemType)
+{
+    using enum SystemType;
+    return std::to_array<EnumName<SystemType>>({
+        {BlueStar, "BLUE_STAR"},
+        {OrangeStar, "ORANGE_STAR"},
+        {RedStar, "RED_STAR"},
+        {WhiteDwarf, "WHITE_DWARF"},
+        {YoungStar, "YOUNG_STAR"},
+    });
+}
 
 struct System {
-    std::string symbol;
-    std::string sectorSymbol;
+    SystemName symbol;
+    SectorName sectorSymbol;
     SystemType type;
     Point<float> point;
     std::vector<Waypoint> waypoints;
 };
 
+constexpr auto jsonFields(std::type_identity<System>)
+{
+    return std::tuple{
+        JsonField{"symbol", &System::symbol},
+        JsonField{"sectorSymbol", &System::sectorSymbol},
+        JsonField{"type", &System::type},
+        JsonField{"x", [] (System& s) -> auto& { return s.point.x; }},
+        JsonField{"y", [] (System& s) -> auto& { return s.point.y; }},
+        JsonField{"waypoints", &System::waypoints},
+    };
+}
+
 enum class TestEnum {
     One,
     Two,
     ThreeFour,
 };
 
-template <>
-inline TestEnum fromString<TestEnum>(std::string_view string)
+constexpr auto enumNames(TestEnum)
 {
-    if (string == "ONE") return TestEnum::One;
-    if (string == "TWO") return TestEnum::Two;
-    if (string == "THREE_FOUR") return TestEnum::ThreeFour;
-    throw e::Error{} << "unknown name (" << string << ") of " << "TestEnum";
-}
-
-inline std::istream& operator>>(std::istream& input, TestEnum& value)
-{
-    auto string = std::string{};
-    input >> string;
-    value = fromString<TestEnum>(string);
-    return input;
-}
-
-inline std::ostream& operator<<(std::ostream& output, const TestEnum& value)
-{
-    switch (value) {
-        case TestEnum::One: return output << "ONE";
-        case TestEnum::Two: return output << "TWO";
-        case TestEnum::ThreeFour: return output << "THREE_FOUR";
-    }
-    throw e::Error{} <<
-        "unknown value (" << std::to_underlying(value) << ") of " << "TestEnum";
+    using enum TestEnum;
+    return std::to_array<EnumName<TestEnum>>({
+        {One, "ONE"},
+        {Two, "TWO"},
+        {ThreeFour, "THREE_FOUR"},
+    });
 }
 
 enum class TraitSymbol {
@@ -158,7 +157,46 @@ enum class TraitSymbol {
     Diverse,
 };
 
-extern template TraitSymbol fromString<TraitSymbol>(std::string_view string);
+constexpr auto enumNames(TraitSymbol)
+{
+    using enum TraitSymbol;
+    return std::to_array<EnumName<TraitSymbol>>({
+        {Innovative, "INNOVATIVE"},
+        {Bold, "BOLD"},
+        {Visionary, "VISIONARY"},
+        {Cooperative, "COOPERATIVE"},
+        {Curious, "CURIOUS"},
+        {United, "UNITED"},
+        {Peaceful, "PEACEFUL"},
+        {Strategic, "STRATEGIC"},
+        {Intelligent, "INTELLIGENT"},
+        {ResearchFocused, "RESEARCH_FOCUSED"},
+        {Collaborative, "COLLABORATIVE"},
+        {Progressive, "PROGRESSIVE"},
+        {Militaristic, "MILITARISTIC"},
+        {Aggressive, "AGGRESSIVE"},
+        {Imperialistic, "IMPERIALISTIC"},
+        {Industrious, "INDUSTRIOUS"},
+        {Scavengers, "SCAVENGERS"},
+        {TreasureHunters, "TREASURE_HUNTERS"},
+        {Resourceful, "RESOURCEFUL"},
+        {Dexterous, "DEXTEROUS"},
+        {Unpredictable, "UNPREDICTABLE"},
+        {Brutal, "BRUTAL"},
+        {Fleeting, "FLEETING"},
+        {Adaptable, "ADAPTABLE"},
+        {Daring, "DARING"},
+        {Exploratory, "EXPLORATORY"},
+        {Flexible, "FLEXIBLE"},
+        {Secretive, "SECRETIVE"},
+        {Smugglers, "SMUGGLERS"},
+        {Defensive, "DEFENSIVE"},
+        {SelfSufficient, "SELF_SUFFICIENT"},
+        {Proud, "PROUD"},
+        {Welcoming, "WELCOMING"},
+        {Diverse, "DIVERSE"},
+    });
+}
 
 struct Trait {
     static Trait json(const nlohmann::json& j);
@@ -168,6 +206,15 @@ struct Trait {
     std::string description;
 };
 
+constexpr auto jsonFields(std::type_identity<Trait>)
+{
+    return std::tuple{
+        JsonField{"symbol", &Trait::symbol},
+        JsonField{"name", &Trait::name},
+        JsonField{"description", &Trait::description},
+    };
+}
+
 struct Faction {
     static Faction json(const nlohmann::json& j);
 
@@ -178,3 +225,16 @@ struct Faction {
     std::vector<Trait> traits;
     bool isRecruiting = false;
 };
+
+constexpr auto jsonFields(std::type_identity<Faction>)
+{
+    return std::tuple{
+        JsonField{"symbol", &Faction::symbol},
+        JsonField{"name", &Faction::name},
+        JsonField{"description", &Faction::description},
+        JsonField{
+            "headquarters", &Faction::headquarters, JsonPresence::Optional},
+        JsonField{"traits", &Faction::traits},
+        JsonField{"isRecruiting", &Faction::isRecruiting},
+    };
+}
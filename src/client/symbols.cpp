@@ -0,0 +1,159 @@
+#include "symbols.hpp"
+
+#include <error.hpp>
+
+#include <array>
+#include <mutex>
+
+namespace {
+
+constexpr auto sectorBits = 8;
+constexpr auto systemBits = 24;
+
+Interner& sectorParts()
+{
+    static auto interner = Interner{(uint64_t{1} << sectorBits) - 1};
+    return interner;
+}
+
+Interner& systemParts()
+{
+    static auto interner = Interner{(uint64_t{1} << systemBits) - 1};
+    return interner;
+}
+
+Interner& pointParts()
+{
+    static auto interner = Interner{UINT32_MAX};
+    return interner;
+}
+
+// splits `name` into exactly `N` non-empty runs of [A-Z0-9] separated by
+// single dashes
+template <size_t N>
+std::array<std::string_view, N> split(std::string_view name)
+{
+    auto parts = std::array<std::string_view, N>{};
+    size_t part = 0;
+    size_t start = 0;
+    for (size_t i = 0; i <= name.size(); i++) {
+        if (i < name.size() && name[i] != '-') {
+            char c = name[i];
+            if (!((c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9'))) {
+                throw e::Error{} << "bad character in symbol " << name;
+            }
+            continue;
+        }
+        if (i == start || part == N) {
+            throw e::Error{} << "malformed symbol " << name;
+        }
+        parts[part++] = name.substr(start, i - start);
+        start = i + 1;
+    }
+    if (part != N) {
+        throw e::Error{} << "malformed symbol " << name;
+    }
+    return parts;
+}
+
+} // namespace
+
+Interner::Interner(uint64_t limit)
+    : _limit(limit)
+{
+}
+
+uint32_t Interner::intern(std::string_view name)
+{
+    {
+        auto lock = std::shared_lock{_mutex};
+        if (auto it = _ids.find(name); it != _ids.end()) {
+            return it->second;
+        }
+    }
+
+    auto lock = std::unique_lock{_mutex};
+    if (auto it = _ids.find(name); it != _ids.end()) {
+        return it->second;
+    }
+    if (_names.size() >= _limit) {
+        throw e::Error{} << "too many distinct symbols (" << _limit <<
+            "), cannot add " << name;
+    }
+    const auto& stored = _names.emplace_back(name);
+    auto id = static_cast<uint32_t>(_names.size());
+    _ids.emplace(stored, id);
+    return id;
+}
+
+std::string_view Interner::name(uint32_t id) const
+{
+    if (id == 0) {
+        return {};
+    }
+    auto lock = std::shared_lock{_mutex};
+    return _names.at(id - 1);
+}
+
+size_t Interner::size() const
+{
+    auto lock = std::shared_lock{_mutex};
+    return _names.size();
+}
+
+SectorName::SectorName(std::string_view name)
+    : _id(sectorParts().intern(split<1>(name)[0]))
+{
+}
+
+std::ostream& operator<<(std::ostream& output, const SectorName& sector)
+{
+    return output << sectorParts().name(sector._id);
+}
+
+SystemName::SystemName(std::string_view name)
+{
+    auto [sector, system] = split<2>(name);
+    _id = SectorName{sector}.id() << systemBits |
+        systemParts().intern(system);
+}
+
+SectorName SystemName::sector() const
+{
+    auto sector = SectorName{};
+    sector._id = _id >> systemBits;
+    return sector;
+}
+
+std::ostream& operator<<(std::ostream& output, const SystemName& system)
+{
+    if (system._id == 0) {
+        return output;
+    }
+    return output << system.sector() << "-" <<
+        systemParts().name(system._id & ((1u << systemBits) - 1));
+}
+
+WaypointName::WaypointName(std::string_view name)
+{
+    auto [sector, system, point] = split<3>(name);
+    auto systemId = SectorName{sector}.id() << systemBits |
+        systemParts().intern(system);
+    _id = uint64_t{systemId} << 32 | pointParts().intern(point);
+}
+
+SystemName WaypointName::system() const
+{
+    auto system = SystemName{};
+    system._id = static_cast<uint32_t>(_id >> 32);
+    return system;
+}
+
+std::ostream& operator<<(std::ostream& output, const WaypointName& waypoint)
+{
+    if (waypoint._id == 0) {
+        return output;
+    }
+    return output << waypoint.system() << "-" <<
+        pointParts().name(static_cast<uint32_t>(waypoint._id));
+}
\ No newline at end of file
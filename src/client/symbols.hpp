@@ -0,0 +1,127 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <ostream>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+// Thread-safe table of strings, each stored once and numbered densely from
+// 1. Names live until the program exits, so the views name() returns never
+// dangle.
+class Interner {
+public:
+    explicit Interner(uint64_t limit);
+
+    uint32_t intern(std::string_view name);
+    std::string_view name(uint32_t id) const;
+    size_t size() const;
+
+private:
+    mutable std::shared_mutex _mutex;
+    std::deque<std::string> _names;
+    std::unordered_map<std::string_view, uint32_t> _ids;
+    uint64_t _limit;
+};
+
+// "X1-GA69-A1" is stored as three interned parts: the sector "X1", the
+// system "GA69" and the point "A1", each in its own table. Names compare by
+// ID, which is the order the parts were first seen, not alphabetical order.
+// A default-constructed name is empty and prints as "". Constructing a name
+// from anything but [A-Z0-9] parts joined by single dashes throws.
+
+// up to 255 sectors
+class SectorName {
+public:
+    SectorName() = default;
+    explicit SectorName(std::string_view name);
+
+    uint32_t id() const
+    {
+        return _id;
+    }
+
+    auto operator<=>(const SectorName&) const = default;
+
+    friend std::ostream& operator<<(
+        std::ostream& output, const SectorName& sector);
+
+private:
+    friend class SystemName;
+
+    uint32_t _id = 0;
+};
+
+// sector in the top 8 bits, system part in the low 24
+class SystemName {
+public:
+    SystemName() = default;
+    explicit SystemName(std::string_view name);
+
+    uint32_t id() const
+    {
+        return _id;
+    }
+
+    SectorName sector() const;
+
+    auto operator<=>(const SystemName&) const = default;
+
+    friend std::ostream& operator<<(
+        std::ostream& output, const SystemName& system);
+
+private:
+    friend class WaypointName;
+
+    uint32_t _id = 0;
+};
+
+// system ID in the top 32 bits, point part in the low 32
+class WaypointName {
+public:
+    WaypointName() = default;
+    explicit WaypointName(std::string_view name);
+
+    uint64_t id() const
+    {
+        return _id;
+    }
+
+    SystemName system() const;
+
+    auto operator<=>(const WaypointName&) const = default;
+
+    friend std::ostream& operator<<(
+        std::ostream& output, const WaypointName& waypoint);
+
+private:
+    uint64_t _id = 0;
+};
+
+template <>
+struct std::hash<SectorName> {
+    size_t operator()(const SectorName& sector) const noexcept
+    {
+        return std::hash<uint32_t>{}(sector.id());
+    }
+};
+
+template <>
+struct std::hash<SystemName> {
+    size_t operator()(const SystemName& system) const noexcept
+    {
+        return std::hash<uint32_t>{}(system.id());
+    }
+};
+
+template <>
+struct std::hash<WaypointName> {
+    size_t operator()(const WaypointName& waypoint) const noexcept
+    {
+        return std::hash<uint64_t>{}(waypoint.id());
+    }
+};
\ No newline at end of file
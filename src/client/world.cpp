@@ -1,8 +1,11 @@
 #include "world.hpp"
 
+#include "decode.hpp"
+
+#include <error.hpp>
 #include <fs.hpp>
 
-#include <format>
+#include <chrono>
 #include <utility>
 #include <vector>
 #include <set>
@@ -13,62 +16,75 @@ const auto url = http::URL{"https://api.spacetraders.io/v2"};
 
 } // namespace
 
-World::World()
-    : _token(fs::readText(fs::home() / ".space_traders_token"))
+World::World(http::Cassette* cassette)
+    : _cache(fs::home() / ".space_traders_cache")
 {
-    //auto agentData = _http(http::Request{
-    //    .url = url / "my/agent",
-    //    .headers = {authHeader()},
-    //});
-
-    //auto json = agentData.json();
-    //auto headquarters = Waypoint{json["headquarters"]};
-
-    auto systemsJson = _http(http::Request{
-        .url = url / "systems",
-        .headers = {authHeader()},
-    }).json();
-
-    const auto& systems = systemsJson["data"];
-    for (const auto& s : systems) {
-        auto system = System{
-            .symbol = s["symbol"],
-            .sectorSymbol = s["sectorSymbol"],
-            .type = systemType(s["type"]),
-            .point = Point<float>{s["x"], s["y"]},
-            .waypoints = {},
-        };
+    _http.baseUrl(url);
 
-        for (const auto& w : s["waypoints"]) {
-            auto waypoint = Waypoint{
-                .symbol = w["symbol"],
-                .type = fromString<WaypointType>(w["type"]),
-                .point = Point<float>{w["x"], w["y"]},
-                .orbitals = {},
-            };
-
-            for (const auto& o : w["orbitals"]) {
-                auto orbital = std::string{o["symbol"]};
-                waypoint.orbitals.push_back(std::move(orbital));
-            }
-
-            system.waypoints.push_back(std::move(waypoint));
+    // a replayed session never reaches the server, so it needs no token
+    if (cassette) {
+        _http.useCassette(*cassette);
+    }
+    if (!cassette || !cassette->replaying()) {
+        auto tokenFile = fs::home() / ".space_traders_token";
+        _credentials.emplace(tokenFile);
+        if (!_credentials->authorization()) {
+            throw e::Error{} << "no token in " << tokenFile.string();
         }
+        _http.useCredentials(*_credentials);
+    }
 
+    _cache.policy(url / "systems", std::chrono::hours{24});
+    _cache.policy(url / "systems/{}", std::chrono::hours{24});
+    _cache.policy(url / "factions", std::chrono::hours{24});
+    _cache.policy(url / "factions/{}", std::chrono::hours{24});
+
+    _http.useShare(http::Share::global());
+    _http.useRateLimiter(_rateLimiter);
+    _http.useCache(_cache);
+    _http.useRetryPolicy(_retryPolicy);
+    _http.useMetrics(_metrics);
+    _http.useExecutor(_executor);
+
+    _executor.spawn(loadAgent());
+
+    auto systems = http::PageStream<System>{
+        _http,
+        http::Request{
+            .url = "systems",
+        },
+        pageDecoder<System>,
+    };
+    for (auto& system : systems) {
         _systems.push_back(std::move(system));
     }
 
-    auto factionsJson = _http(http::Request{
-        .url = url / "factions",
-        .headers = {authHeader()},
-    }).json();
-
-    for (const auto& faction : factionsJson["data"]) {
-        _factions.push_back(Faction::json(faction));
+    auto factions = http::PageStream<Faction>{
+        _http,
+        http::Request{
+            .url = "factions",
+        },
+        pageDecoder<Faction>,
+    };
+    for (auto& faction : factions) {
+        _factions.push_back(std::move(faction));
     }
 }
 
-std::pair<std::string, std::string> World::authHeader() const
+void World::update()
+{
+    _executor.poll();
+}
+
+http::Task<> World::loadAgent()
 {
-    return {"Authorization", std::format("Bearer {}", _token)};
+    auto request = http::Request{.url = "my/agent"};
+    auto response = co_await _http.async(std::move(request));
+    if (response.code >= 400) {
+        throw e::Error{} << "HTTP " << response.code << " for my/agent: " <<
+            response.contents;
+    }
+    auto json = response.json();
+    _headquarters = WaypointName{
+        json["data"]["headquarters"].get_ref<const std::string&>()};
 }
\ No newline at end of file
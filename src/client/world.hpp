@@ -4,27 +4,54 @@
 #include "protocol.hpp"
 
 #include <http.hpp>
+#include <http/cache.hpp>
+#include <http/cassette.hpp>
+#include <http/credentials.hpp>
+#include <http/metrics.hpp>
+#include <http/multi.hpp>
+#include <http/rate_limiter.hpp>
+#include <http/retry.hpp>
+#include <http/task.hpp>
 
 #include <istream>
+#include <optional>
 #include <ostream>
 #include <string>
 #include <string_view>
 
 class World {
 public:
-    World();
+    explicit World(http::Cassette* cassette = nullptr);
 
     const std::vector<System>& systems() const
     {
         return _systems;
     }
 
+    const std::optional<WaypointName>& headquarters() const
+    {
+        return _headquarters;
+    }
+
+    const http::Metrics& metrics() const
+    {
+        return _metrics;
+    }
+
+    void update();
 
 private:
-    std::pair<std::string, std::string> authHeader() const;
+    http::Task<> loadAgent();
+
+    http::Executor _executor;
+    http::RateLimiter _rateLimiter;
+    http::Cache _cache;
+    http::RetryPolicy _retryPolicy;
+    http::Metrics _metrics;
+    std::optional<http::Credentials> _credentials;
+    http::MultiSession _http;
 
-    std::string _token;
-    http::Session _http;
+    std::optional<WaypointName> _headquarters;
 
     std::vector<System> _systems;
     std::vector<Faction> _factions;
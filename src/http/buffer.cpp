@@ -0,0 +1,46 @@
+#include <http/buffer.hpp>
+
+#include <algorithm>
+#include <utility>
+
+namespace http {
+
+BufferPool::BufferPool(size_t maxBuffers)
+    : _maxBuffers(maxBuffers)
+{ }
+
+std::string BufferPool::acquire()
+{
+    auto lock = std::lock_guard{_mutex};
+    if (_buffers.empty()) {
+        return {};
+    }
+    auto buffer = std::move(_buffers.back());
+    _buffers.pop_back();
+    return buffer;
+}
+
+void BufferPool::release(std::string buffer)
+{
+    if (buffer.capacity() == 0) {
+        return;
+    }
+    buffer.clear();
+
+    auto lock = std::lock_guard{_mutex};
+    if (_buffers.size() < _maxBuffers) {
+        _buffers.push_back(std::move(buffer));
+    } else if (!_buffers.empty()) {
+        auto smallest = std::ranges::min_element(
+            _buffers, {}, [] (const auto& b) { return b.capacity(); });
+        if (smallest->capacity() < buffer.capacity()) {
+            *smallest = std::move(buffer);
+        }
+    }
+
+    // keep the largest buffer at the back, so big pages get big buffers
+    std::ranges::sort(
+        _buffers, {}, [] (const auto& b) { return b.capacity(); });
+}
+
+} // namespace http
\ No newline at end of file
@@ -0,0 +1,294 @@
+#include <http/cache.hpp>
+
+#include "storage.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <format>
+#include <fstream>
+#include <functional>
+#include <ios>
+#include <random>
+#include <system_error>
+#include <thread>
+
+namespace http {
+
+namespace {
+
+// whether `url` is `pattern` with each "{}" standing for one path segment
+bool matches(std::string_view pattern, std::string_view url)
+{
+    while (true) {
+        auto hole = pattern.find("{}");
+        if (hole == std::string_view::npos) {
+            return url == pattern;
+        }
+        if (!url.starts_with(pattern.substr(0, hole))) {
+            return false;
+        }
+        url.remove_prefix(hole);
+        pattern.remove_prefix(hole + 2);
+
+        auto segment = std::min(url.find('/'), url.size());
+        if (segment == 0) {
+            return false;
+        }
+        url.remove_prefix(segment);
+    }
+}
+
+} // namespace
+
+std::string requestKey(const Request& request, const Headers& defaultHeaders)
+{
+    if (effectiveMethod(request) != Method::GET) {
+        return {};
+    }
+
+    auto key = std::format("GET {}", request.url);
+    char separator = '?';
+    for (const auto& [name, value] : request.params) {
+        key += separator;
+        key += name;
+        key += '=';
+        key += value;
+        separator = '&';
+    }
+
+    for (const auto* name : {"Authorization", "Accept"}) {
+        auto value = request.headers.get(name);
+        if (!value) {
+            value = defaultHeaders.get(name);
+        }
+        if (value) {
+            key += std::format("\n{}: {:016x}", name, fnv1a(*value));
+        }
+    }
+    return key;
+}
+
+Cache::Cache(
+        std::filesystem::path directory,
+        size_t memoryEntries,
+        std::chrono::seconds defaultTtl)
+    : _directory(std::move(directory))
+    , _memoryEntries(memoryEntries)
+    , _defaultTtl(defaultTtl)
+{ }
+
+void Cache::policy(std::string urlPattern, std::chrono::seconds ttl)
+{
+    auto lock = std::lock_guard{_mutex};
+    _policies.emplace_back(std::move(urlPattern), ttl);
+}
+
+std::optional<Response> Cache::prepare(
+    Request& request, CacheLookup& lookup, const Headers& defaultHeaders)
+{
+    lookup = CacheLookup{.key = requestKey(request, defaultHeaders)};
+    if (lookup.key.empty()) {
+        return std::nullopt;
+    }
+
+    auto entry = find(lookup.key);
+    if (!entry) {
+        return std::nullopt;
+    }
+
+    if (Clock::now() - entry->storedAt < ttl(lookup.key)) {
+        return std::move(entry->response);
+    }
+
+    // a 304 has no body to stream into the sink
+    if (request.sink) {
+        return std::nullopt;
+    }
+
+    if (auto etag = entry->response.header("ETag")) {
+        request.headers.emplace("If-None-Match", *etag);
+    }
+    if (auto lastModified = entry->response.header("Last-Modified")) {
+        request.headers.emplace("If-Modified-Since", *lastModified);
+    }
+    lookup.stale = std::move(entry->response);
+    return std::nullopt;
+}
+
+Response Cache::complete(CacheLookup lookup, Response response)
+{
+    const auto& key = lookup.key;
+    if (key.empty()) {
+        return response;
+    }
+
+    if (response.code == 304) {
+        auto entry = find(key);
+        if (!entry && lookup.stale) {
+            entry = Entry{.response = std::move(*lookup.stale)};
+        }
+        if (!entry) {
+            return response;
+        }
+        entry->storedAt = Clock::now();
+        remember(key, *entry);
+        save(key, *entry);
+        return std::move(entry->response);
+    }
+
+    // an entry is only worth its disk write if it can be served fresh or
+    // revalidated later
+    auto cacheControl = response.header("Cache-Control").value_or("");
+    bool useful = ttl(key) > std::chrono::seconds{0} ||
+        response.header("ETag") || response.header("Last-Modified");
+    // a body that went only into a sink is not there to store
+    bool whole = response.bodySize.decoded ==
+        static_cast<int64_t>(response.contents.size());
+    if (response.code == 200 && useful && whole &&
+            cacheControl.find("no-store") == std::string_view::npos) {
+        auto entry = Entry{
+            .storedAt = Clock::now(),
+            .response = response,
+        };
+        remember(key, entry);
+        save(key, entry);
+    }
+    return response;
+}
+
+bool Cache::keeps(const std::string& key) const
+{
+    return !key.empty() && ttl(key) > std::chrono::seconds{0};
+}
+
+std::chrono::seconds Cache::ttl(const std::string& key) const
+{
+    auto url = std::string_view{key}.substr(key.find(' ') + 1);
+    url = url.substr(0, url.find_first_of("?\n"));
+    auto lock = std::lock_guard{_mutex};
+    for (const auto& [pattern, ttl] : _policies) {
+        if (matches(pattern, url)) {
+            return ttl;
+        }
+    }
+    return _defaultTtl;
+}
+
+std::optional<Cache::Entry> Cache::find(const std::string& key)
+{
+    {
+        auto lock = std::lock_guard{_mutex};
+        if (auto it = _index.find(key); it != _index.end()) {
+            _lru.splice(_lru.begin(), _lru, it->second);
+            return it->second->second;
+        }
+    }
+
+    auto entry = load(key);
+    if (entry) {
+        remember(key, *entry);
+    }
+    return entry;
+}
+
+void Cache::remember(const std::string& key, Entry entry)
+{
+    auto lock = std::lock_guard{_mutex};
+    if (auto it = _index.find(key); it != _index.end()) {
+        it->second->second = std::move(entry);
+        _lru.splice(_lru.begin(), _lru, it->second);
+        return;
+    }
+
+    _lru.emplace_front(key, std::move(entry));
+    _index.emplace(key, _lru.begin());
+    while (_lru.size() > _memoryEntries) {
+        _index.erase(_lru.back().first);
+        _lru.pop_back();
+    }
+}
+
+std::optional<Cache::Entry> Cache::load(const std::string& key) const
+{
+    if (_directory.empty()) {
+        return std::nullopt;
+    }
+
+    auto input = std::ifstream{file(key), std::ios::binary};
+    if (!input) {
+        return std::nullopt;
+    }
+
+    auto magic = std::string{};
+    std::getline(input, magic);
+    if (magic != "st-cache 1" || readString(input) != key) {
+        return std::nullopt;
+    }
+
+    auto seconds = int64_t{0};
+    auto entry = Entry{};
+    input >> seconds >> entry.response.code;
+    entry.storedAt = Clock::time_point{std::chrono::seconds{seconds}};
+    entry.response.headers = readHeaders(input);
+    entry.response.contents = readString(input);
+
+    if (!input) {
+        return std::nullopt;
+    }
+    return entry;
+}
+
+void Cache::save(const std::string& key, const Entry& entry) const
+{
+    if (_directory.empty()) {
+        return;
+    }
+
+    // the cache is an optimization: failing to persist an entry is not an
+    // error for the request that produced it
+    auto error = std::error_code{};
+    std::filesystem::create_directories(_directory, error);
+    if (error) {
+        return;
+    }
+
+    // each writer has its own temporary file, so that concurrent saves of
+    // one key, from this process or another, never mix their bytes
+    static const auto salt = std::random_device{}();
+    static auto saves = std::atomic<uint64_t>{0};
+    auto path = file(key);
+    auto temporaryPath = path;
+    temporaryPath += std::format(
+        ".{:08x}.{:016x}.{}.tmp",
+        salt,
+        std::hash<std::thread::id>{}(std::this_thread::get_id()),
+        saves++);
+    {
+        auto output = std::ofstream{temporaryPath, std::ios::binary};
+        output << "st-cache 1\n";
+        writeString(output, key);
+        output <<
+            std::chrono::duration_cast<std::chrono::seconds>(
+                entry.storedAt.time_since_epoch()).count() << '\n' <<
+            entry.response.code << '\n';
+        writeHeaders(output, entry.response.headers);
+        writeString(output, entry.response.contents);
+        if (!output) {
+            output.close();
+            std::filesystem::remove(temporaryPath, error);
+            return;
+        }
+    }
+    std::filesystem::rename(temporaryPath, path, error);
+    if (error) {
+        std::filesystem::remove(temporaryPath, error);
+    }
+}
+
+std::filesystem::path Cache::file(const std::string& key) const
+{
+    return _directory / std::format("{:016x}", fnv1a(key));
+}
+
+} // namespace http
\ No newline at end of file
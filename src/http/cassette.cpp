@@ -0,0 +1,162 @@
+#include <http/cassette.hpp>
+
+#include "storage.hpp"
+
+#include <error.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <format>
+#include <ios>
+
+namespace http {
+
+namespace {
+
+const auto magic = std::string{"st-cassette 1"};
+
+void writeResponse(std::ostream& output, const Response& response)
+{
+    const auto& t = response.timings;
+    output << response.code << '\n';
+    writeHeaders(output, response.headers);
+    writeString(output, response.contents);
+    output <<
+        response.bodySize.wire << ' ' <<
+        response.bodySize.decoded << ' ' <<
+        response.bodySize.sent << '\n' <<
+        t.nameLookup.count() << ' ' <<
+        t.connect.count() << ' ' <<
+        t.appConnect.count() << ' ' <<
+        t.startTransfer.count() << ' ' <<
+        t.total.count() << '\n';
+}
+
+Response readResponse(std::istream& input)
+{
+    auto response = Response{};
+    input >> response.code;
+    response.headers = readHeaders(input);
+    response.contents = readString(input);
+    input >>
+        response.bodySize.wire >>
+        response.bodySize.decoded >>
+        response.bodySize.sent;
+
+    auto time = [&input] {
+        auto microseconds = int64_t{0};
+        input >> microseconds;
+        return std::chrono::microseconds{microseconds};
+    };
+    auto& t = response.timings;
+    t.nameLookup = time();
+    t.connect = time();
+    t.appConnect = time();
+    t.startTransfer = time();
+    t.total = time();
+    return response;
+}
+
+} // namespace
+
+Cassette::Cassette(std::filesystem::path path, Mode mode)
+    : _mode(mode)
+{
+    if (replaying()) {
+        load(path);
+        return;
+    }
+
+    _output.open(path, std::ios::binary | std::ios::trunc);
+    if (!_output) {
+        throw e::Error{} << "cannot write cassette " << path.string();
+    }
+    _output << magic << '\n';
+}
+
+Cassette::Mode Cassette::mode() const
+{
+    return _mode;
+}
+
+bool Cassette::replaying() const
+{
+    return _mode != Mode::Record;
+}
+
+std::string Cassette::key(const Request& request)
+{
+    auto key = std::format(
+        "{} {}",
+        effectiveMethod(request) == Method::POST ? "POST" : "GET",
+        request.url);
+
+    char separator = '?';
+    for (const auto& [name, value] : request.params) {
+        key += separator;
+        key += name;
+        key += '=';
+        key += value;
+        separator = '&';
+    }
+
+    if (!request.data.empty()) {
+        key += std::format("\n{:016x}", fnv1a(request.data));
+    } else if (!request.json.empty()) {
+        key += std::format("\n{:016x}", fnv1a(request.json.dump()));
+    } else if (!request.body.empty()) {
+        auto body = std::string_view{
+            reinterpret_cast<const char*>(request.body.data()),
+            request.body.size()};
+        key += std::format("\n{:016x}", fnv1a(body));
+    }
+    return key;
+}
+
+void Cassette::record(const std::string& key, const Response& response)
+{
+    auto lock = std::lock_guard{_mutex};
+    if (replaying()) {
+        return;
+    }
+    writeString(_output, key);
+    writeResponse(_output, response);
+    _output.flush();
+}
+
+Response Cassette::replay(const std::string& key)
+{
+    auto lock = std::lock_guard{_mutex};
+    auto it = _tracks.find(key);
+    if (it == _tracks.end()) {
+        throw e::Error{} << "no recorded response for " << key;
+    }
+
+    auto& track = it->second;
+    const auto& response = track.responses.at(track.next);
+    if (track.next + 1 < track.responses.size()) {
+        track.next++;
+    }
+    return response;
+}
+
+void Cassette::load(const std::filesystem::path& path)
+{
+    auto input = std::ifstream{path, std::ios::binary};
+    auto header = std::string{};
+    std::getline(input, header);
+    if (!input || header != magic) {
+        throw e::Error{} << "not a cassette: " << path.string();
+    }
+
+    while ((input >> std::ws).peek() != std::ifstream::traits_type::eof()) {
+        auto key = readString(input);
+        auto response = readResponse(input);
+        if (!input) {
+            throw e::Error{} << "truncated cassette: " << path.string();
+        }
+        _tracks[key].responses.push_back(std::move(response));
+    }
+}
+
+} // namespace http
\ No newline at end of file
@@ -0,0 +1,174 @@
+#include <http/credentials.hpp>
+
+#ifdef __linux__
+    #include <poll.h>
+    #include <sys/eventfd.h>
+    #include <sys/inotify.h>
+    #include <unistd.h>
+
+    #include <array>
+    #include <cerrno>
+    #include <cstring>
+#endif
+
+#include <chrono>
+#include <fstream>
+#include <system_error>
+#include <utility>
+
+namespace http {
+
+Credentials::Credentials(std::filesystem::path path)
+    : _path(std::move(path))
+{
+    reload();
+#ifdef __linux__
+    _wakeup = ::eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+#endif
+    _thread = std::jthread{[this] (std::stop_token stopToken) {
+        watch(stopToken);
+    }};
+}
+
+Credentials::~Credentials()
+{
+    _thread.request_stop();
+#ifdef __linux__
+    if (_wakeup != -1) {
+        uint64_t one = 1;
+        [[maybe_unused]] auto written = ::write(_wakeup, &one, sizeof(one));
+    }
+#endif
+    _thread.join();
+#ifdef __linux__
+    if (_wakeup != -1) {
+        ::close(_wakeup);
+    }
+#endif
+}
+
+std::shared_ptr<const std::string> Credentials::authorization() const
+{
+    return _authorization.load(std::memory_order_acquire);
+}
+
+uint64_t Credentials::version() const
+{
+    return _version.load(std::memory_order_acquire);
+}
+
+void Credentials::reload()
+{
+    // a missing or empty file (say, halfway through a rotation) keeps the
+    // token there was
+    auto file = std::ifstream{_path};
+    auto token = std::string{};
+    if (!(file >> token) || token.empty()) {
+        return;
+    }
+
+    auto header = std::make_shared<const std::string>("Bearer " + token);
+    auto current = _authorization.load(std::memory_order_acquire);
+    if (current && *current == *header) {
+        return;
+    }
+    _authorization.store(std::move(header), std::memory_order_release);
+    _version.fetch_add(1, std::memory_order_acq_rel);
+}
+
+#ifdef __linux__
+
+void Credentials::watch(std::stop_token stopToken)
+{
+    int inotify = ::inotify_init1(IN_CLOEXEC | IN_NONBLOCK);
+    if (inotify == -1 || _wakeup == -1) {
+        if (inotify != -1) {
+            ::close(inotify);
+        }
+        poll(stopToken);
+        return;
+    }
+
+    // the directory is watched rather than the file, which editors and
+    // rotation scripts tend to replace instead of rewriting
+    auto directory = _path.parent_path();
+    if (::inotify_add_watch(
+            inotify,
+            directory.empty() ? "." : directory.c_str(),
+            IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE) == -1) {
+        ::close(inotify);
+        poll(stopToken);
+        return;
+    }
+
+    auto name = _path.filename().string();
+    auto fds = std::array<pollfd, 2>{
+        pollfd{.fd = inotify, .events = POLLIN, .revents = 0},
+        pollfd{.fd = _wakeup, .events = POLLIN, .revents = 0},
+    };
+    alignas(inotify_event) char buffer[4096];
+
+    while (!stopToken.stop_requested()) {
+        if (::poll(fds.data(), fds.size(), -1) == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+        if (fds[1].revents) {
+            break;
+        }
+
+        bool changed = false;
+        for (;;) {
+            auto size = ::read(inotify, buffer, sizeof(buffer));
+            if (size <= 0) {
+                break;
+            }
+            for (auto* ptr = buffer; ptr < buffer + size; ) {
+                const auto* event = reinterpret_cast<const inotify_event*>(ptr);
+                if (event->len > 0 && name == event->name) {
+                    changed = true;
+                }
+                ptr += sizeof(inotify_event) + event->len;
+            }
+        }
+        if (changed) {
+            reload();
+        }
+    }
+    ::close(inotify);
+}
+
+#else
+
+void Credentials::watch(std::stop_token stopToken)
+{
+    poll(stopToken);
+}
+
+#endif
+
+void Credentials::poll(std::stop_token stopToken)
+{
+    auto modified = [this] {
+        auto error = std::error_code{};
+        return std::filesystem::last_write_time(_path, error);
+    };
+
+    auto lastModified = modified();
+    auto lock = std::unique_lock{_mutex};
+    for (;;) {
+        _stopped.wait_for(
+            lock, stopToken, std::chrono::seconds{1}, [] { return false; });
+        if (stopToken.stop_requested()) {
+            return;
+        }
+        if (auto time = modified(); time != lastModified) {
+            lastModified = time;
+            reload();
+        }
+    }
+}
+
+} // namespace http
\ No newline at end of file
@@ -48,9 +48,63 @@ void Handle::perform()
     checkCurl(curl_easy_perform(_ptr.get()));
 }
 
+CURLcode Handle::tryPerform() noexcept
+{
+    return curl_easy_perform(_ptr.get());
+}
+
+CURL* Handle::ptr()
+{
+    return _ptr.get();
+}
+
+const CURL* Handle::ptr() const
+{
+    return _ptr.get();
+}
+
 void swap(Handle& lhs, Handle& rhs) noexcept
 {
     std::swap(lhs._ptr, rhs._ptr);
 }
 
+MultiHandle::MultiHandle()
+{
+    _ptr.reset(checkCurl(curl_multi_init()));
+}
+
+void MultiHandle::add(Handle& handle)
+{
+    checkCurl(curl_multi_add_handle(_ptr.get(), handle.ptr()));
+}
+
+void MultiHandle::remove(Handle& handle)
+{
+    checkCurl(curl_multi_remove_handle(_ptr.get(), handle.ptr()));
+}
+
+int MultiHandle::perform()
+{
+    int runningHandles = 0;
+    checkCurl(curl_multi_perform(_ptr.get(), &runningHandles));
+    return runningHandles;
+}
+
+void MultiHandle::poll(std::chrono::milliseconds timeout)
+{
+    checkCurl(curl_multi_poll(
+        _ptr.get(), nullptr, 0, static_cast<int>(timeout.count()), nullptr));
+}
+
+void MultiHandle::wakeup()
+{
+    checkCurl(curl_multi_wakeup(_ptr.get()));
+}
+
+CURLMsg* MultiHandle::infoRead()
+{
+    int messagesInQueue = 0;
+    return curl_multi_info_read(_ptr.get(), &messagesInQueue);
+}
+
 } // namespace http
\ No newline at end of file
@@ -0,0 +1,72 @@
+#include <http/defaults.hpp>
+
+#include <http.hpp>
+
+#include <format>
+
+namespace http {
+
+Defaults::Defaults(const Defaults& other)
+    : _baseUrl(other._baseUrl)
+    , _headers(other._headers)
+{
+    rebuild();
+}
+
+Defaults& Defaults::operator=(const Defaults& other)
+{
+    if (this != &other) {
+        _baseUrl = other._baseUrl;
+        _headers = other._headers;
+        rebuild();
+    }
+    return *this;
+}
+
+void Defaults::baseUrl(std::string url)
+{
+    while (url.ends_with('/')) {
+        url.pop_back();
+    }
+    _baseUrl = std::move(url);
+}
+
+void Defaults::header(std::string_view name, std::string_view value)
+{
+    _headers.set(name, value);
+    rebuild();
+}
+
+void Defaults::resolve(Request& request) const
+{
+    if (_baseUrl.empty() || request.url.find("://") != std::string::npos) {
+        return;
+    }
+
+    auto path = std::string_view{request.url};
+    while (path.starts_with('/')) {
+        path.remove_prefix(1);
+    }
+    request.url = std::format("{}/{}", _baseUrl, path);
+}
+
+const Headers& Defaults::headers() const
+{
+    return _headers;
+}
+
+curl_slist* Defaults::headerList() const
+{
+    return _headerList.ptr();
+}
+
+void Defaults::rebuild()
+{
+    auto list = StringList{};
+    for (const auto& [name, value] : _headers) {
+        list.append(std::format("{}: {}", name, value));
+    }
+    _headerList = std::move(list);
+}
+
+} // namespace http
\ No newline at end of file
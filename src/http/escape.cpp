@@ -0,0 +1,147 @@
+#include <http.hpp>
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define HTTP_ESCAPE_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace http {
+
+namespace {
+
+constexpr auto unreserved = [] {
+    auto table = std::array<bool, 256>{};
+    for (auto c = 'A'; c <= 'Z'; c++) {
+        table[static_cast<unsigned char>(c)] = true;
+    }
+    for (auto c = 'a'; c <= 'z'; c++) {
+        table[static_cast<unsigned char>(c)] = true;
+    }
+    for (auto c = '0'; c <= '9'; c++) {
+        table[static_cast<unsigned char>(c)] = true;
+    }
+    for (auto c : {'-', '.', '_', '~'}) {
+        table[static_cast<unsigned char>(c)] = true;
+    }
+    return table;
+}();
+
+#ifdef HTTP_ESCAPE_SSE2
+
+// Length of the run of unreserved characters at the start of `string`,
+// checked 16 bytes at a time. Bytes of 0x80 and up are negative as signed
+// chars and fall outside every range.
+size_t unreservedPrefix(std::string_view string)
+{
+    auto inRange = [] (__m128i v, char low, char high) {
+        return _mm_and_si128(
+            _mm_cmpgt_epi8(v, _mm_set1_epi8(static_cast<char>(low - 1))),
+            _mm_cmplt_epi8(v, _mm_set1_epi8(static_cast<char>(high + 1))));
+    };
+
+    size_t i = 0;
+    for (; i + 16 <= string.size(); i += 16) {
+        auto v = _mm_loadu_si128(
+            reinterpret_cast<const __m128i*>(string.data() + i));
+
+        // setting 0x20 folds upper case onto lower case and maps nothing
+        // else into a..z
+        auto letter = inRange(_mm_or_si128(v, _mm_set1_epi8(0x20)), 'a', 'z');
+        auto digit = inRange(v, '0', '9');
+        auto mark = _mm_or_si128(
+            _mm_or_si128(
+                _mm_cmpeq_epi8(v, _mm_set1_epi8('-')),
+                _mm_cmpeq_epi8(v, _mm_set1_epi8('.'))),
+            _mm_or_si128(
+                _mm_cmpeq_epi8(v, _mm_set1_epi8('_')),
+                _mm_cmpeq_epi8(v, _mm_set1_epi8('~'))));
+        auto mask = static_cast<uint32_t>(_mm_movemask_epi8(
+            _mm_or_si128(_mm_or_si128(letter, digit), mark)));
+
+        if (mask != 0xffff) {
+            return i + std::countr_one(mask);
+        }
+    }
+
+    while (i < string.size() && unreserved[static_cast<uint8_t>(string[i])]) {
+        i++;
+    }
+    return i;
+}
+
+#else
+
+size_t unreservedPrefix(std::string_view string)
+{
+    size_t i = 0;
+    while (i < string.size() && unreserved[static_cast<uint8_t>(string[i])]) {
+        i++;
+    }
+    return i;
+}
+
+#endif
+
+} // namespace
+
+void appendEscaped(std::string& output, std::string_view string)
+{
+    static constexpr char hex[] = "0123456789ABCDEF";
+
+    while (!string.empty()) {
+        auto run = unreservedPrefix(string);
+        output.append(string.substr(0, run));
+        string.remove_prefix(run);
+
+        for (; !string.empty(); string.remove_prefix(1)) {
+            auto c = static_cast<uint8_t>(string.front());
+            if (unreserved[c]) {
+                break;
+            }
+            output += '%';
+            output += hex[c >> 4];
+            output += hex[c & 0xf];
+        }
+    }
+}
+
+std::string escape(std::string_view string)
+{
+    auto result = std::string{};
+    result.reserve(string.size());
+    appendEscaped(result, string);
+    return result;
+}
+
+std::string buildUrl(
+    std::string_view url, const std::map<std::string, std::string>& params)
+{
+    // room for the query as if nothing needed escaping: the common case
+    // then never reallocates
+    auto size = url.size();
+    for (const auto& [name, value] : params) {
+        size += name.size() + value.size() + 2;
+    }
+
+    auto result = std::string{};
+    result.reserve(size);
+    result.append(url);
+
+    char separator = '?';
+    for (const auto& [name, value] : params) {
+        result += separator;
+        appendEscaped(result, name);
+        result += '=';
+        appendEscaped(result, value);
+        separator = '&';
+    }
+    return result;
+}
+
+} // namespace http
\ No newline at end of file
@@ -0,0 +1,189 @@
+#include <http/file_sink.hpp>
+
+#include <error.hpp>
+
+#ifdef _WIN32
+    #include <Windows.h>
+#else
+    #include <fcntl.h>
+    #include <unistd.h>
+
+    #include <cerrno>
+    #include <cstring>
+#endif
+
+#include <algorithm>
+#include <utility>
+
+namespace http {
+
+namespace {
+
+#ifdef _WIN32
+
+[[noreturn]] void throwFileError(
+    const char* operation, const std::filesystem::path& path)
+{
+    throw e::Error{} << operation << " " << path.string() << " failed: " <<
+        GetLastError();
+}
+
+#else
+
+[[noreturn]] void throwFileError(
+    const char* operation, const std::filesystem::path& path)
+{
+    throw e::Error{} << operation << " " << path.string() << " failed: " <<
+        std::strerror(errno);
+}
+
+#endif
+
+} // namespace
+
+#ifdef _WIN32
+
+FileSink::FileSink(const std::filesystem::path& path)
+    : _path(path)
+{
+    auto file = CreateFileW(
+        path.c_str(),
+        GENERIC_WRITE,
+        0,
+        NULL,
+        CREATE_ALWAYS,
+        FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN,
+        NULL);
+    if (file == INVALID_HANDLE_VALUE) {
+        throwFileError("opening", path);
+    }
+    _file = file;
+}
+
+void FileSink::expect(size_t contentLength)
+{
+    // reserves the space without moving the end of the file
+    auto allocation = FILE_ALLOCATION_INFO{};
+    allocation.AllocationSize.QuadPart = static_cast<LONGLONG>(contentLength);
+    SetFileInformationByHandle(
+        _file, FileAllocationInfo, &allocation, sizeof(allocation));
+}
+
+void FileSink::write(std::string_view chunk)
+{
+    while (!chunk.empty()) {
+        auto size = static_cast<DWORD>(
+            std::min<size_t>(chunk.size(), MAXDWORD));
+        auto written = DWORD{0};
+        if (!WriteFile(_file, chunk.data(), size, &written, NULL)) {
+            throwFileError("writing", _path);
+        }
+        chunk.remove_prefix(written);
+        _size += written;
+    }
+}
+
+void FileSink::finish()
+{
+    if (!FlushFileBuffers(_file)) {
+        throwFileError("flushing", _path);
+    }
+}
+
+void FileSink::close() noexcept
+{
+    if (_file) {
+        CloseHandle(_file);
+        _file = nullptr;
+    }
+}
+
+#else
+
+FileSink::FileSink(const std::filesystem::path& path)
+    : _path(path)
+{
+    _file = ::open(
+        path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (_file == -1) {
+        throwFileError("opening", path);
+    }
+}
+
+void FileSink::expect(size_t contentLength)
+{
+    // posix_fallocate() moves the end of the file, which finish() puts back
+    // where the body actually ended; failing to preallocate is not an error
+    _preallocated = ::posix_fallocate(
+        _file, 0, static_cast<off_t>(contentLength)) == 0;
+}
+
+void FileSink::write(std::string_view chunk)
+{
+    while (!chunk.empty()) {
+        auto written = ::write(_file, chunk.data(), chunk.size());
+        if (written == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throwFileError("writing", _path);
+        }
+        chunk.remove_prefix(static_cast<size_t>(written));
+        _size += static_cast<uint64_t>(written);
+    }
+}
+
+void FileSink::finish()
+{
+    if (_preallocated) {
+        if (::ftruncate(_file, static_cast<off_t>(_size)) == -1) {
+            throwFileError("truncating", _path);
+        }
+        _preallocated = false;
+    }
+}
+
+void FileSink::close() noexcept
+{
+    if (_file != -1) {
+        // a failed transfer never reaches finish(): the file still has to
+        // end where the body did, but there is no one to report errors to
+        if (_preallocated &&
+                ::ftruncate(_file, static_cast<off_t>(_size)) == -1) {
+            _preallocated = false;
+        }
+        ::close(_file);
+        _file = -1;
+    }
+}
+
+#endif
+
+FileSink::~FileSink()
+{
+    close();
+}
+
+uint64_t FileSink::size() const
+{
+    return _size;
+}
+
+CallbackSink::CallbackSink(Callback onChunk, std::function<void()> onFinish)
+    : _onChunk(std::move(onChunk))
+    , _onFinish(std::move(onFinish))
+{ }
+
+void CallbackSink::write(std::string_view chunk)
+{
+    _onChunk(chunk);
+}
+
+void CallbackSink::finish()
+{
+    if (_onFinish) {
+        _onFinish();
+    }
+}
+
+} // namespace http
\ No newline at end of file
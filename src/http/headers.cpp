@@ -0,0 +1,184 @@
+#include <http/headers.hpp>
+
+#include <error.hpp>
+
+#include <algorithm>
+#include <limits>
+
+namespace http {
+
+namespace {
+
+char toLower(char c)
+{
+    return c >= 'A' && c <= 'Z' ? static_cast<char>(c - 'A' + 'a') : c;
+}
+
+std::string_view trim(std::string_view string)
+{
+    auto first = string.find_first_not_of(" \t\r\n");
+    if (first == std::string_view::npos) {
+        return {};
+    }
+    auto last = string.find_last_not_of(" \t\r\n");
+    return string.substr(first, last - first + 1);
+}
+
+} // namespace
+
+bool equalsIgnoreCase(std::string_view lhs, std::string_view rhs)
+{
+    return std::ranges::equal(lhs, rhs, [] (char a, char b) {
+        return toLower(a) == toLower(b);
+    });
+}
+
+Headers::Headers(std::initializer_list<value_type> headers)
+{
+    _fields.reserve(headers.size());
+    for (const auto& [name, value] : headers) {
+        add(name, value);
+    }
+}
+
+void Headers::add(std::string_view name, std::string_view value)
+{
+    auto [nameOffset, nameSize] = store(trim(name));
+    auto [valueOffset, valueSize] = store(trim(value));
+    _fields.push_back(Field{
+        .nameOffset = nameOffset,
+        .nameSize = nameSize,
+        .valueOffset = valueOffset,
+        .valueSize = valueSize,
+    });
+}
+
+bool Headers::emplace(std::string_view name, std::string_view value)
+{
+    if (contains(name)) {
+        return false;
+    }
+    add(name, value);
+    return true;
+}
+
+void Headers::set(std::string_view name, std::string_view value)
+{
+    auto found = find(name);
+    if (!found) {
+        add(name, value);
+        return;
+    }
+
+    value = trim(value);
+    auto& field = _fields.at(static_cast<size_t>(found - _fields.data()));
+    if (value.size() <= field.valueSize) {
+        // a value no longer than the old one takes its place
+        _arena.replace(field.valueOffset, value.size(), value);
+        _orphaned += field.valueSize - value.size();
+        field.valueSize = static_cast<uint32_t>(value.size());
+    } else {
+        _orphaned += field.valueSize;
+        auto [valueOffset, valueSize] = store(value);
+        field.valueOffset = valueOffset;
+        field.valueSize = valueSize;
+    }
+
+    // a header set over and over, like a rotated token, would otherwise
+    // grow the arena without bound
+    if (_orphaned > _arena.size() / 2) {
+        compact();
+    }
+}
+
+void Headers::clear()
+{
+    _arena.clear();
+    _fields.clear();
+    _orphaned = 0;
+}
+
+bool Headers::contains(std::string_view name) const
+{
+    return find(name) != nullptr;
+}
+
+std::optional<std::string_view> Headers::get(std::string_view name) const
+{
+    if (auto field = find(name)) {
+        return std::string_view{_arena}.substr(
+            field->valueOffset, field->valueSize);
+    }
+    return std::nullopt;
+}
+
+size_t Headers::size() const
+{
+    return _fields.size();
+}
+
+bool Headers::empty() const
+{
+    return _fields.empty();
+}
+
+Headers::value_type Headers::at(size_t index) const
+{
+    const auto& field = _fields.at(index);
+    auto arena = std::string_view{_arena};
+    return {
+        arena.substr(field.nameOffset, field.nameSize),
+        arena.substr(field.valueOffset, field.valueSize),
+    };
+}
+
+Headers::Iterator Headers::begin() const
+{
+    return Iterator{this, 0};
+}
+
+Headers::Iterator Headers::end() const
+{
+    return Iterator{this, _fields.size()};
+}
+
+const Headers::Field* Headers::find(std::string_view name) const
+{
+    auto arena = std::string_view{_arena};
+    for (const auto& field : _fields) {
+        if (equalsIgnoreCase(
+                arena.substr(field.nameOffset, field.nameSize), name)) {
+            return &field;
+        }
+    }
+    return nullptr;
+}
+
+std::pair<uint32_t, uint32_t> Headers::store(std::string_view string)
+{
+    e::require(
+        _arena.size() + string.size() <= std::numeric_limits<uint32_t>::max(),
+        "header arena overflow");
+    auto offset = static_cast<uint32_t>(_arena.size());
+    _arena.append(string);
+    return {offset, static_cast<uint32_t>(string.size())};
+}
+
+void Headers::compact()
+{
+    auto arena = std::string{};
+    arena.reserve(_arena.size() - _orphaned);
+    auto move = [this, &arena] (uint32_t& offset, uint32_t size) {
+        auto newOffset = static_cast<uint32_t>(arena.size());
+        arena.append(_arena, offset, size);
+        offset = newOffset;
+    };
+    for (auto& field : _fields) {
+        move(field.nameOffset, field.nameSize);
+        move(field.valueOffset, field.valueSize);
+    }
+    _arena = std::move(arena);
+    _orphaned = 0;
+}
+
+} // namespace http
\ No newline at end of file
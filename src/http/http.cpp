@@ -1,177 +1,242 @@
 #include "http.hpp"
+#include "transfer.hpp"
+
+#include <http/cache.hpp>
+#include <http/cassette.hpp>
+#include <http/credentials.hpp>
+#include <http/metrics.hpp>
+#include <http/rate_limiter.hpp>
+#include <http/retry.hpp>
 
 #include <curl/curl.h>
 
-#include <cctype>
-#include <algorithm>
-#include <format>
-#include <limits>
-#include <ostream>
-#include <sstream>
-#include <utility>
+#include <thread>
 
 namespace http {
 
-namespace {
-
-size_t readDataCallback(
-    char* buffer, size_t, size_t nitems, std::istream* input)
+Init::Init()
 {
-    input->read(buffer, nitems);
-    return input->gcount();
+    checkCurl(curl_global_init(CURL_GLOBAL_ALL));
 }
 
-size_t writeDataCallback(
-    void* buffer, size_t, size_t nmemb, std::ostream* output)
+Init::~Init()
 {
-    output->write(reinterpret_cast<const char*>(buffer), nmemb);
-    return nmemb;
+    curl_global_cleanup();
 }
 
-size_t writeHeadersCallback(
-    char* buffer,
-    size_t,
-    size_t nitems,
-    std::map<std::string, std::string>* headers)
+Method effectiveMethod(const Request& request)
 {
-    auto string = std::string_view{buffer, nitems};
-    size_t separator = string.find(":");
-    if (separator == string.npos) {
-        return nitems;
+    if (request.method != Method::UNSET) {
+        return request.method;
     }
-
-    auto name = string.substr(0, separator);
-    auto value = string.substr(separator + 1);
-    headers->emplace(name, value);
-    return nitems;
+    if (!request.data.empty() || !request.json.empty() ||
+            !request.body.empty()) {
+        return Method::POST;
+    }
+    return Method::GET;
 }
 
-void polishRequestInPlace(Request& request)
+double BodySize::compressionRatio() const
 {
-    const bool hasData = !request.data.empty();
-    const bool hasJson = !request.json.empty();
-
-    if (hasData && hasJson) {
-        throw e::Error{} << "cannot set both .data and .json in http::Request";
+    if (wire == 0) {
+        return 1.0;
     }
+    return static_cast<double>(decoded) / static_cast<double>(wire);
+}
 
-    if (request.method == Method::UNSET) {
-        if (hasData || hasJson) {
-            request.method = Method::POST;
-        } else {
-            request.method = Method::GET;
-        }
-    }
+nlohmann::json Response::json() const
+{
+    return nlohmann::json::parse(contents);
+}
 
-    if (!request.headers.contains("Content-Type")) {
-        if (hasJson) {
-            request.headers.emplace("Content-Type", "application/json");
-        }
-    }
+std::optional<std::string_view> Response::header(std::string_view name) const
+{
+    return headers.get(name);
 }
 
-} // namespace
+Session::Session()
+{
+    setupHandle(_handle);
+}
 
-bool CaseInsensitiveLess::operator()(
-    std::string lhs, std::string rhs) const
+Session::Session(const Session& other)
+    : _handle(other._handle)
+    , _defaults(other._defaults)
+    , _share(other._share)
+    , _rateLimiter(other._rateLimiter)
+    , _cache(other._cache)
+    , _metrics(other._metrics)
+    , _cassette(other._cassette)
+    , _retryPolicy(other._retryPolicy)
+    , _credentials(other._credentials)
+    , _credentialsVersion(other._credentialsVersion)
+{ }
+
+void Session::useShare(Share& share)
 {
-    auto charToLower = [] (unsigned char c) {
-        return static_cast<char>(std::tolower(c));
-    };
+    _handle.setopt(CURLOPT_SHARE, share.ptr());
+    _share = &share;
+}
 
-    std::ranges::transform(lhs, lhs.begin(), charToLower);
-    std::ranges::transform(rhs, rhs.begin(), charToLower);
-    return lhs < rhs;
+void Session::useRateLimiter(RateLimiter& rateLimiter)
+{
+    _rateLimiter = &rateLimiter;
 }
 
-std::string escape(const std::string& string)
+void Session::useCache(Cache& cache)
 {
-    e::require(string.length() <= std::numeric_limits<int>::max());
-    auto length = static_cast<int>(string.length());
+    _cache = &cache;
+}
 
-    char* ptr = checkCurl(curl_easy_escape(nullptr, string.c_str(), length));
-    auto result = std::string{ptr};
-    curl_free(ptr);
-    return result;
+void Session::useMetrics(Metrics& metrics)
+{
+    _metrics = &metrics;
 }
 
-Init::Init()
+void Session::useCassette(Cassette& cassette)
 {
-    checkCurl(curl_global_init(CURL_GLOBAL_ALL));
+    _cassette = &cassette;
 }
 
-Init::~Init()
+void Session::useRetryPolicy(const RetryPolicy& policy)
 {
-    curl_global_cleanup();
+    _retryPolicy = &policy;
 }
 
-nlohmann::json Response::json() const
+void Session::useCredentials(const Credentials& credentials)
 {
-    return nlohmann::json::parse(contents);
+    _credentials = &credentials;
+    _credentialsVersion = 0;
 }
 
-Session::Session()
+void Session::baseUrl(std::string url)
 {
-    _handle.setopt(CURLOPT_FOLLOWLOCATION, 1);
-    _handle.setopt(CURLOPT_READFUNCTION, readDataCallback);
-    _handle.setopt(CURLOPT_WRITEFUNCTION, writeDataCallback);
-    _handle.setopt(CURLOPT_HEADERFUNCTION, writeHeadersCallback);
+    _defaults.baseUrl(std::move(url));
 }
 
-Response Session::operator()(Request request)
+void Session::defaultHeader(std::string_view name, std::string_view value)
 {
-    polishRequestInPlace(request);
+    _defaults.header(name, value);
+}
 
-    if (request.method == Method::POST) {
-        _handle.setopt(CURLOPT_POST, 1);
+Response Session::operator()(Request request)
+{
+    if (_credentials) {
+        if (auto version = _credentials->version();
+                version != _credentialsVersion) {
+            if (auto authorization = _credentials->authorization()) {
+                _defaults.header("Authorization", *authorization);
+            }
+            _credentialsVersion = version;
+        }
     }
 
-    auto urlStream = std::ostringstream{};
-    urlStream << request.url;
-
-    bool hasWritten = false;
-    for (const auto& [name, value] : request.params) {
-        if (!hasWritten) {
-            urlStream << "?";
-            hasWritten = true;
-        } else {
-            urlStream << "&";
+    _defaults.resolve(request);
+    auto* sink = request.sink;
+    auto response = Response{};
+    if (_cassette && _cassette->replaying()) {
+        response = _cassette->replay(Cassette::key(request));
+        if (_cassette->mode() == Cassette::Mode::ReplayWithLatency) {
+            std::this_thread::sleep_for(response.timings.total);
         }
-        urlStream << escape(name) << "=" << escape(value);
+        if (sink && response.code < 400) {
+            feedSink(*sink, response.contents);
+        }
+    } else if (_cassette) {
+        auto key = Cassette::key(request);
+        response = perform(std::move(request), sink != nullptr);
+        _cassette->record(key, response);
+    } else {
+        response = perform(std::move(request), false);
+    }
+
+    // a sink gets the body instead of contents, except for an error status
+    if (sink && response.code < 400) {
+        recycle(std::move(response));
+        response.contents.clear();
     }
-    auto urlString = urlStream.str();
-    _handle.setopt(CURLOPT_URL, urlString.c_str());
+    return response;
+}
 
-    auto headerStringList = StringList{};
-    for (const auto& [name, value] : request.headers) {
-        headerStringList.append(std::format("{}: {}", name, value));
+// `keepBody` keeps a body streamed into the request's sink in contents too
+Response Session::perform(Request request, bool keepBody)
+{
+    // a sink is handed cached bodies as if they were downloaded, and gets
+    // fresh ones while they download
+    auto* sink = request.sink;
+    auto lookup = CacheLookup{};
+    if (_cache) {
+        if (auto cached =
+                _cache->prepare(request, lookup, _defaults.headers())) {
+            if (sink) {
+                feedSink(*sink, cached->contents);
+            }
+            return std::move(*cached);
+        }
     }
-    _handle.setopt(CURLOPT_HTTPHEADER, headerStringList.ptr());
-
-    auto dataInput = std::istringstream{};
-    auto dataBuffer = std::string{};
-    if (!request.data.empty()) {
-        dataInput = std::istringstream{request.data};
-    } else if (!request.json.empty()) {
-        dataBuffer = request.json.dump();
-        dataInput = std::istringstream{dataBuffer};
+    keepBody = keepBody || (sink && _cache && _cache->keeps(lookup.key));
+
+    // a retried request is copied into each attempt; the others are moved
+    bool retry = _retryPolicy && _retryPolicy->isRetryable(request);
+    if (retry && !request.params.empty()) {
+        // every attempt reuses the URL encoded here
+        request.url = buildUrl(request.url, request.params);
+        request.params.clear();
     }
-    dataInput.exceptions(std::ios::badbit);
-    _handle.setopt(CURLOPT_READDATA, &dataInput);
+    for (auto attempt = 1; ; attempt++) {
+        if (_rateLimiter) {
+            _rateLimiter->acquire(request.priority);
+        }
 
-    auto responseData = std::ostringstream{};
-    _handle.setopt(CURLOPT_WRITEDATA, &responseData);
+        auto transfer = Transfer{
+            _handle,
+            retry ? request : std::move(request),
+            _buffers.acquire(),
+            &_defaults,
+            keepBody};
+        auto code = _handle.tryPerform();
+        if (_share) {
+            _share->record(_handle);
+        }
+
+        // a sink that got part of a failed body has to start over
+        auto rewound = [&transfer] {
+            return !transfer.wroteToSink() ||
+                transfer.request().sink->rewind();
+        };
+
+        bool again = retry && attempt < _retryPolicy->maxAttempts;
+        if (again && _retryPolicy->isTransient(code) && rewound()) {
+            _buffers.release(transfer.releaseBuffer());
+            std::this_thread::sleep_for(_retryPolicy->delay(attempt));
+            continue;
+        }
 
-    auto responseHeaders = std::map<std::string, std::string>{};
-    _handle.setopt(CURLOPT_HEADERDATA, &responseHeaders);
+        auto response = transfer.finish(code);
+        if (_metrics) {
+            _metrics->record(transfer.request(), response);
+        }
+        if (_rateLimiter) {
+            _rateLimiter->update(response);
+        }
+        if (again && _retryPolicy->isTransient(response) && rewound()) {
+            auto delay = _retryPolicy->delay(attempt, &response);
+            recycle(std::move(response));
+            std::this_thread::sleep_for(delay);
+            continue;
+        }
 
-    _handle.perform();
+        if (_cache) {
+            response = _cache->complete(
+                std::move(lookup), std::move(response));
+        }
+        return response;
+    }
+}
 
-    return Response{
-        .code = _handle.getinfo<long>(CURLINFO_RESPONSE_CODE),
-        .headers = std::move(responseHeaders),
-        .contents = responseData.str(),
-    };
+void Session::recycle(Response&& response)
+{
+    _buffers.release(std::move(response.contents));
 }
 
 } // namespace http
\ No newline at end of file
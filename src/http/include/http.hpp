@@ -1,20 +1,32 @@
 #pragma once
 
+#include <http/buffer.hpp>
 #include <http/curl.hpp>
+#include <http/defaults.hpp>
+#include <http/headers.hpp>
+#include <http/share.hpp>
+#include <http/sink.hpp>
 
 #include <nlohmann/json.hpp>
 
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
 #include <map>
+#include <optional>
+#include <span>
 #include <string>
+#include <string_view>
 
 namespace http {
 
-class CaseInsensitiveLess {
-public:
-    bool operator()(std::string lhs, std::string rhs) const;
-};
+// Percent-encoding of everything but the RFC 3986 unreserved characters
+std::string escape(std::string_view string);
+void appendEscaped(std::string& output, std::string_view string);
 
-std::string escape(const std::string& string);
+// `url` followed by the query string encoded from `params`
+std::string buildUrl(
+    std::string_view url, const std::map<std::string, std::string>& params);
 
 class Init {
 public:
@@ -64,31 +76,107 @@ enum class Method {
     POST,
 };
 
+enum class Priority {
+    Interactive,
+    Normal,
+    Background,
+};
+
 struct Request {
     Method method = Method::UNSET;
     std::string url;
     std::map<std::string, std::string> params;
-    std::map<std::string, std::string, CaseInsensitiveLess> headers;
+    Headers headers;
     std::string data;
     nlohmann::json json;
+    // uploaded straight from the caller's memory, which has to stay valid
+    // until the response arrives
+    std::span<const std::byte> body;
+    // receives the body instead of Response::contents; an error status
+    // (400 and up) keeps its body in contents
+    Sink* sink = nullptr;
+    Priority priority = Priority::Normal;
+};
+
+// The method a request is sent with: an UNSET method means POST when there
+// is a body, GET otherwise.
+Method effectiveMethod(const Request& request);
+
+struct BodySize {
+    double compressionRatio() const;
+
+    int64_t wire = 0;
+    int64_t decoded = 0;
+    int64_t sent = 0;
+};
+
+// Time from the start of the transfer until each phase completed, as
+// libcurl reports it. Phases a transfer skipped (DNS and connect on a
+// reused connection, TLS on plain HTTP) are zero.
+struct Timings {
+    std::chrono::microseconds nameLookup{};
+    std::chrono::microseconds connect{};
+    std::chrono::microseconds appConnect{};
+    std::chrono::microseconds startTransfer{};
+    std::chrono::microseconds total{};
 };
 
 struct Response {
     nlohmann::json json() const;
+    std::optional<std::string_view> header(std::string_view name) const;
 
     long code = 0;
-    std::map<std::string, std::string> headers;
+    Headers headers;
     std::string contents;
+    BodySize bodySize;
+    Timings timings;
 };
 
+class Cache;
+class Cassette;
+class Credentials;
+class Metrics;
+class RateLimiter;
+struct RetryPolicy;
+
+// A session is used by one thread at a time; see SessionPool for sessions
+// shared between threads.
 class Session {
 public:
     Session();
 
+    // a session configured like `other`, with a duplicate of its handle
+    Session(const Session& other);
+    Session& operator=(const Session&) = delete;
+
+    void useShare(Share& share);
+    void useRateLimiter(RateLimiter& rateLimiter);
+    void useCache(Cache& cache);
+    void useMetrics(Metrics& metrics);
+    void useCassette(Cassette& cassette);
+    void useRetryPolicy(const RetryPolicy& policy);
+    void useCredentials(const Credentials& credentials);
+
+    void baseUrl(std::string url);
+    void defaultHeader(std::string_view name, std::string_view value);
+
     Response operator()(Request request);
+    void recycle(Response&& response);
 
 private:
+    Response perform(Request request, bool keepBody);
+
     Handle _handle;
+    Defaults _defaults;
+    Share* _share = nullptr;
+    RateLimiter* _rateLimiter = nullptr;
+    Cache* _cache = nullptr;
+    Metrics* _metrics = nullptr;
+    Cassette* _cassette = nullptr;
+    const RetryPolicy* _retryPolicy = nullptr;
+    const Credentials* _credentials = nullptr;
+    uint64_t _credentialsVersion = 0;
+    BufferPool _buffers;
 };
 
 } // namespace http
\ No newline at end of file
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <cstddef>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace http {
+
+class BufferPool {
+public:
+    explicit BufferPool(size_t maxBuffers = 8);
+
+    std::string acquire();
+    void release(std::string buffer);
+
+private:
+    std::mutex _mutex;
+    std::vector<std::string> _buffers;
+    size_t _maxBuffers = 0;
+};
+
+} // namespace http
\ No newline at end of file
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <http.hpp>
+
+#include <chrono>
+#include <cstddef>
+#include <filesystem>
+#include <list>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace http {
+
+// Identifies a GET by its URL, parameters and the headers that select the
+// response. Empty for anything but a GET.
+std::string requestKey(
+    const Request& request, const Headers& defaultHeaders = {});
+
+// What Cache::prepare() found for a request, to be handed to complete()
+struct CacheLookup {
+    std::string key;
+    // the stale response a conditional request revalidates, so that a 304
+    // can be answered even if its entry is evicted in the meantime
+    std::optional<Response> stale;
+};
+
+// Policies match the URL of a request without its parameters, in full; a
+// "{}" in one matches a single path segment, as in url / "systems/{}".
+class Cache {
+public:
+    using Clock = std::chrono::system_clock;
+
+    explicit Cache(
+        std::filesystem::path directory = {},
+        size_t memoryEntries = 256,
+        std::chrono::seconds defaultTtl = std::chrono::seconds{0});
+
+    void policy(std::string urlPattern, std::chrono::seconds ttl);
+
+    std::optional<Response> prepare(
+        Request& request,
+        CacheLookup& lookup,
+        const Headers& defaultHeaders = {});
+    Response complete(CacheLookup lookup, Response response);
+
+    // whether a request streaming into a Sink should also keep its body,
+    // so that complete() can store it
+    bool keeps(const std::string& key) const;
+
+private:
+    struct Entry {
+        Clock::time_point storedAt;
+        Response response;
+    };
+
+    std::chrono::seconds ttl(const std::string& key) const;
+    std::optional<Entry> find(const std::string& key);
+    void remember(const std::string& key, Entry entry);
+
+    std::optional<Entry> load(const std::string& key) const;
+    void save(const std::string& key, const Entry& entry) const;
+    std::filesystem::path file(const std::string& key) const;
+
+    std::filesystem::path _directory;
+    size_t _memoryEntries = 0;
+    std::chrono::seconds _defaultTtl;
+    std::vector<std::pair<std::string, std::chrono::seconds>> _policies;
+
+    mutable std::mutex _mutex;
+    std::list<std::pair<std::string, Entry>> _lru;
+    std::unordered_map<
+        std::string,
+        std::list<std::pair<std::string, Entry>>::iterator> _index;
+};
+
+} // namespace http
\ No newline at end of file
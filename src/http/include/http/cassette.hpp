@@ -0,0 +1,57 @@
+#pragma once
+
+#include <http.hpp>
+
+#include <cstddef>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace http {
+
+// Records the responses a session hands out to a file, and serves them
+// back without touching the network. Requests are matched by method, URL,
+// params and body, not by headers, so a cassette recorded with one token
+// replays without any. Identical requests are answered in recorded order;
+// once a request's recordings run out, the last one is repeated.
+class Cassette {
+public:
+    enum class Mode {
+        Record,
+        Replay,
+        ReplayWithLatency,
+    };
+
+    Cassette(std::filesystem::path path, Mode mode);
+
+    Cassette(const Cassette&) = delete;
+    Cassette(Cassette&&) = delete;
+    Cassette& operator=(const Cassette&) = delete;
+    Cassette& operator=(Cassette&&) = delete;
+
+    Mode mode() const;
+    bool replaying() const;
+
+    static std::string key(const Request& request);
+
+    void record(const std::string& key, const Response& response);
+    Response replay(const std::string& key);
+
+private:
+    struct Track {
+        std::vector<Response> responses;
+        size_t next = 0;
+    };
+
+    void load(const std::filesystem::path& path);
+
+    Mode _mode;
+    std::mutex _mutex;
+    std::ofstream _output;
+    std::unordered_map<std::string, Track> _tracks;
+};
+
+} // namespace http
\ No newline at end of file
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <stop_token>
+#include <string>
+#include <thread>
+
+namespace http {
+
+// A bearer token kept in a file. The file is read once and then watched
+// (inotify on Linux, the modification time elsewhere); a new token replaces
+// the old one atomically. Sessions given this with useCredentials() send
+// the current token without reading anything on the request path.
+class Credentials {
+public:
+    explicit Credentials(std::filesystem::path path);
+    ~Credentials();
+
+    Credentials(const Credentials&) = delete;
+    Credentials(Credentials&&) = delete;
+    Credentials& operator=(const Credentials&) = delete;
+    Credentials& operator=(Credentials&&) = delete;
+
+    // "Bearer <token>", or null while there has never been a token file
+    std::shared_ptr<const std::string> authorization() const;
+
+    // changes whenever authorization() does
+    uint64_t version() const;
+
+    void reload();
+
+private:
+    void watch(std::stop_token stopToken);
+    void poll(std::stop_token stopToken);
+
+    std::filesystem::path _path;
+    std::atomic<std::shared_ptr<const std::string>> _authorization;
+    std::atomic<uint64_t> _version = 0;
+
+    std::mutex _mutex;
+    std::condition_variable_any _stopped;
+#ifdef __linux__
+    int _wakeup = -1;
+#endif
+    std::jthread _thread;
+};
+
+} // namespace http
\ No newline at end of file
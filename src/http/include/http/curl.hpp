@@ -4,8 +4,11 @@
 
 #include <curl/curl.h>
 
+#include <chrono>
 #include <concepts>
+#include <memory>
 #include <mutex>
+#include <utility>
 
 namespace http {
 
@@ -16,6 +19,13 @@ inline void checkCurl(CURLcode code)
     }
 }
 
+inline void checkCurl(CURLMcode code)
+{
+    if (code != CURLM_OK) {
+        throw e::Error{} << "CURL multi error: " << curl_multi_strerror(code);
+    }
+}
+
 template <class T>
 T* checkCurl(T* ptr)
 {
@@ -33,22 +43,72 @@ public:
         (append(std::forward<Args>(args)), ...);
     }
 
+    StringList(const StringList&) = delete;
+    StringList& operator=(const StringList&) = delete;
+
+    StringList(StringList&& other) noexcept
+        : _list(std::move(other._list))
+        , _last(std::exchange(other._last, nullptr))
+    { }
+
+    StringList& operator=(StringList&& other) noexcept
+    {
+        if (this != &other) {
+            unchain();
+            _list = std::move(other._list);
+            _last = std::exchange(other._last, nullptr);
+        }
+        return *this;
+    }
+
+    ~StringList()
+    {
+        unchain();
+    }
+
     void append(const std::string& string)
     {
+        if (_last) {
+            throw e::Error{} << "cannot append to a chained StringList";
+        }
         curl_slist* p =
             checkCurl(curl_slist_append(_list.get(), string.c_str()));
         _list.release();
         _list.reset(p);
     }
 
-    curl_slist* ptr()
+    // Links a list owned elsewhere after this one, without copying it. The
+    // link is cut again before this list is freed.
+    void chain(curl_slist* tail)
+    {
+        unchain();
+        if (!_list || !tail) {
+            return;
+        }
+        _last = _list.get();
+        while (_last->next) {
+            _last = _last->next;
+        }
+        _last->next = tail;
+    }
+
+    curl_slist* ptr() const
     {
         return _list.get();
     }
 
 private:
+    void unchain() noexcept
+    {
+        if (_last) {
+            _last->next = nullptr;
+            _last = nullptr;
+        }
+    }
+
     std::unique_ptr<curl_slist, void(*)(curl_slist*)> _list = {
         nullptr, curl_slist_free_all};
+    curl_slist* _last = nullptr;
 };
 
 class Handle {
@@ -62,6 +122,10 @@ public:
 
     void clear() noexcept;
     void perform();
+    CURLcode tryPerform() noexcept;
+
+    CURL* ptr();
+    const CURL* ptr() const;
 
     template <class T>
     void setopt(CURLoption option, T&& value)
@@ -84,4 +148,28 @@ private:
     mutable std::mutex _mutex;
 };
 
+class MultiHandle {
+public:
+    MultiHandle();
+
+    void add(Handle& handle);
+    void remove(Handle& handle);
+
+    int perform();
+    void poll(std::chrono::milliseconds timeout);
+    void wakeup();
+    CURLMsg* infoRead();
+
+    template <class T>
+    void setopt(CURLMoption option, T&& value)
+    {
+        checkCurl(
+            curl_multi_setopt(_ptr.get(), option, std::forward<T>(value)));
+    }
+
+private:
+    std::unique_ptr<CURLM, CURLMcode(*)(CURLM*)> _ptr{
+        nullptr, curl_multi_cleanup};
+};
+
 } // namespace http
\ No newline at end of file
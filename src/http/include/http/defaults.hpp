@@ -0,0 +1,38 @@
+#pragma once
+
+#include <http/curl.hpp>
+#include <http/headers.hpp>
+
+#include <string>
+#include <string_view>
+
+namespace http {
+
+struct Request;
+
+// Settings shared by every request of a session. The default headers are
+// kept as a prebuilt curl_slist, so a request only pays for the headers it
+// adds itself.
+class Defaults {
+public:
+    Defaults() = default;
+    Defaults(const Defaults& other);
+    Defaults& operator=(const Defaults& other);
+
+    void baseUrl(std::string url);
+    void header(std::string_view name, std::string_view value);
+
+    void resolve(Request& request) const;
+
+    const Headers& headers() const;
+    curl_slist* headerList() const;
+
+private:
+    void rebuild();
+
+    std::string _baseUrl;
+    Headers _headers;
+    StringList _headerList;
+};
+
+} // namespace http
\ No newline at end of file
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <http/sink.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <string_view>
+
+namespace http {
+
+// Writes a response body straight into a file, chunk by chunk as libcurl
+// delivers it, so that the body is never held in memory. The file is
+// preallocated from Content-Length when the server sends one.
+class FileSink : public Sink {
+public:
+    explicit FileSink(const std::filesystem::path& path);
+    ~FileSink() override;
+
+    FileSink(const FileSink&) = delete;
+    FileSink(FileSink&&) = delete;
+    FileSink& operator=(const FileSink&) = delete;
+    FileSink& operator=(FileSink&&) = delete;
+
+    void expect(size_t contentLength) override;
+    void write(std::string_view chunk) override;
+    void finish() override;
+
+    uint64_t size() const;
+
+private:
+    void close() noexcept;
+
+#ifdef _WIN32
+    void* _file = nullptr;
+#else
+    int _file = -1;
+#endif
+    std::filesystem::path _path;
+    uint64_t _size = 0;
+    bool _preallocated = false;
+};
+
+// Hands every chunk of a response body to a callback
+class CallbackSink : public Sink {
+public:
+    using Callback = std::function<void(std::string_view chunk)>;
+
+    explicit CallbackSink(
+        Callback onChunk, std::function<void()> onFinish = {});
+
+    void write(std::string_view chunk) override;
+    void finish() override;
+
+private:
+    Callback _onChunk;
+    std::function<void()> _onFinish;
+};
+
+} // namespace http
\ No newline at end of file
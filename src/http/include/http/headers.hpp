@@ -0,0 +1,93 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <iterator>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace http {
+
+bool equalsIgnoreCase(std::string_view lhs, std::string_view rhs);
+
+class Headers {
+public:
+    using value_type = std::pair<std::string_view, std::string_view>;
+
+    class Iterator {
+    public:
+        using value_type = Headers::value_type;
+        using difference_type = std::ptrdiff_t;
+
+        Iterator() = default;
+        Iterator(const Headers* headers, size_t index)
+            : _headers(headers)
+            , _index(index)
+        { }
+
+        value_type operator*() const
+        {
+            return _headers->at(_index);
+        }
+
+        Iterator& operator++()
+        {
+            _index++;
+            return *this;
+        }
+
+        Iterator operator++(int)
+        {
+            auto copy = *this;
+            _index++;
+            return copy;
+        }
+
+        bool operator==(const Iterator& other) const = default;
+
+    private:
+        const Headers* _headers = nullptr;
+        size_t _index = 0;
+    };
+
+    Headers() = default;
+    Headers(std::initializer_list<value_type> headers);
+
+    void add(std::string_view name, std::string_view value);
+    bool emplace(std::string_view name, std::string_view value);
+    void set(std::string_view name, std::string_view value);
+    void clear();
+
+    bool contains(std::string_view name) const;
+    std::optional<std::string_view> get(std::string_view name) const;
+
+    size_t size() const;
+    bool empty() const;
+    value_type at(size_t index) const;
+
+    Iterator begin() const;
+    Iterator end() const;
+
+private:
+    struct Field {
+        uint32_t nameOffset = 0;
+        uint32_t nameSize = 0;
+        uint32_t valueOffset = 0;
+        uint32_t valueSize = 0;
+    };
+
+    const Field* find(std::string_view name) const;
+    std::pair<uint32_t, uint32_t> store(std::string_view string);
+    void compact();
+
+    std::string _arena;
+    std::vector<Field> _fields;
+    // arena bytes of values that set() has replaced
+    size_t _orphaned = 0;
+};
+
+} // namespace http
\ No newline at end of file
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <http/sink.hpp>
+
+#include <nlohmann/json.hpp>
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace http {
+
+class JsonStream : public Sink {
+public:
+    explicit JsonStream(nlohmann::json::json_sax_t& handler);
+
+    void write(std::string_view chunk) override;
+    void finish() override;
+
+private:
+    enum class Expect {
+        Value,
+        FirstValueOrEnd,
+        FirstKeyOrEnd,
+        Key,
+        Colon,
+        CommaOrEnd,
+        Done,
+    };
+
+    enum class Lexeme {
+        None,
+        String,
+        Escape,
+        Unicode,
+        Number,
+        Literal,
+    };
+
+    // `position` is the offset of `c` from the start of the document
+    void structural(char c, size_t position);
+    void startValue(char c, size_t position);
+    void afterValue();
+    void endContainer(char c, size_t position);
+
+    void finishString();
+    void finishNumber();
+    void finishLiteral();
+    void finishUnicode(size_t position);
+
+    void accept(bool result);
+
+    nlohmann::json::json_sax_t& _handler;
+    std::vector<char> _containers;
+    Expect _expect = Expect::Value;
+    Lexeme _lexeme = Lexeme::None;
+    bool _stringIsKey = false;
+    bool _aborted = false;
+    std::string _token;
+    size_t _tokenStart = 0;
+    int _hexDigits = 0;
+    uint32_t _codepoint = 0;
+    uint32_t _highSurrogate = 0;
+    size_t _offset = 0;
+};
+
+} // namespace http
\ No newline at end of file
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <http.hpp>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <string_view>
+
+namespace http {
+
+// Log-linear histogram of durations in microseconds, in the style of
+// HdrHistogram: every power of two is split into 16 linear buckets, which
+// keeps the relative error of any reported value under 1/16. Recording is
+// a handful of relaxed atomic increments and never blocks.
+class Histogram {
+public:
+    void record(std::chrono::microseconds value) noexcept;
+
+    uint64_t count() const noexcept;
+    std::chrono::microseconds max() const noexcept;
+    std::chrono::microseconds mean() const noexcept;
+    std::chrono::microseconds percentile(double percent) const noexcept;
+
+private:
+    static constexpr int subBucketBits = 4;
+    static constexpr int maxValueBits = 36;
+    static constexpr size_t bucketCount =
+        (maxValueBits - subBucketBits + 1) << subBucketBits;
+
+    static size_t bucket(uint64_t value) noexcept;
+    static uint64_t highestInBucket(size_t bucket) noexcept;
+
+    std::array<std::atomic<uint64_t>, bucketCount> _buckets{};
+    std::atomic<uint64_t> _count = 0;
+    std::atomic<uint64_t> _sum = 0;
+    std::atomic<uint64_t> _max = 0;
+};
+
+// Per-endpoint latency histograms for every phase of a transfer. Endpoints
+// are named by method and URL path, with symbols such as "X1-DF55" and
+// numeric ids folded into "*" so that the table stays small; "v2" stays.
+class Metrics {
+public:
+    enum class Phase {
+        NameLookup,
+        Connect,
+        Tls,
+        Wait,
+        Transfer,
+        Total,
+    };
+    static constexpr size_t phaseCount = 6;
+
+    class Endpoint {
+    public:
+        explicit Endpoint(std::string name);
+
+        const std::string& name() const;
+        const Histogram& histogram(Phase phase) const;
+        uint64_t bytesReceived() const;
+        uint64_t bytesSent() const;
+
+    private:
+        friend class Metrics;
+
+        std::string _name;
+        std::array<Histogram, phaseCount> _histograms;
+        std::atomic<uint64_t> _bytesReceived = 0;
+        std::atomic<uint64_t> _bytesSent = 0;
+    };
+
+    Metrics() = default;
+    ~Metrics();
+
+    Metrics(const Metrics&) = delete;
+    Metrics(Metrics&&) = delete;
+    Metrics& operator=(const Metrics&) = delete;
+    Metrics& operator=(Metrics&&) = delete;
+
+    void record(const Request& request, const Response& response);
+
+    const Endpoint* endpoint(std::string_view name) const;
+    const Endpoint* endpoint(const Request& request) const;
+    std::chrono::microseconds percentile(
+        const Request& request, Phase phase, double percent) const;
+
+    void dump(std::ostream& output) const;
+
+private:
+    static constexpr size_t slotCount = 128;
+    static constexpr size_t maxNameSize = 128;
+
+    using Name = std::array<char, maxNameSize>;
+
+    static std::string_view endpointName(const Request& request, Name& buffer);
+
+    Endpoint* find(std::string_view name) const;
+    Endpoint& findOrInsert(std::string_view name);
+
+    std::array<std::atomic<Endpoint*>, slotCount> _slots{};
+    Endpoint _overflow{"(other)"};
+};
+
+std::ostream& operator<<(std::ostream& output, Metrics::Phase phase);
+
+} // namespace http
\ No newline at end of file
@@ -0,0 +1,160 @@
+#pragma once
+
+#include <http.hpp>
+#include <http/cache.hpp>
+#include <http/cassette.hpp>
+#include <http/credentials.hpp>
+#include <http/metrics.hpp>
+#include <http/rate_limiter.hpp>
+#include <http/retry.hpp>
+#include <http/task.hpp>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <coroutine>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stop_token>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace http {
+
+class MultiSession {
+public:
+    using Callback = std::function<void(Response)>;
+    using ErrorCallback = std::function<void(std::exception_ptr)>;
+
+    // Result of async(). The awaiting coroutine is resumed through the
+    // executor set with useExecutor(), or on the event loop thread if there
+    // is none.
+    class Awaiter {
+    public:
+        Awaiter(MultiSession& session, Request request, Executor* executor);
+
+        Awaiter(const Awaiter&) = delete;
+        Awaiter(Awaiter&&) = delete;
+        Awaiter& operator=(const Awaiter&) = delete;
+        Awaiter& operator=(Awaiter&&) = delete;
+
+        bool await_ready() const noexcept
+        {
+            return false;
+        }
+
+        bool await_suspend(std::coroutine_handle<> handle);
+        Response await_resume();
+
+    private:
+        void complete();
+
+        MultiSession& _session;
+        Request _request;
+        Executor* _executor = nullptr;
+        std::coroutine_handle<> _handle;
+        std::atomic<bool> _arrived = false;
+        Response _response;
+        std::exception_ptr _error;
+    };
+
+    MultiSession();
+    ~MultiSession();
+
+    MultiSession(const MultiSession&) = delete;
+    MultiSession(MultiSession&&) = delete;
+    MultiSession& operator=(const MultiSession&) = delete;
+    MultiSession& operator=(MultiSession&&) = delete;
+
+    void useShare(Share& share);
+    void useRateLimiter(RateLimiter& rateLimiter);
+    void useCache(Cache& cache);
+    void useExecutor(Executor& executor);
+    void useMetrics(Metrics& metrics);
+    void useCassette(Cassette& cassette);
+    void useRetryPolicy(const RetryPolicy& policy);
+    void useCredentials(const Credentials& credentials);
+
+    void baseUrl(std::string url);
+    void defaultHeader(std::string_view name, std::string_view value);
+
+    std::future<Response> submit(Request request);
+    void submit(Request request, Callback onResponse, ErrorCallback onError);
+    Awaiter async(Request request);
+    void recycle(Response&& response);
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Job;
+    struct Attempt;
+
+    // a response that needs no transfer (cache hit or replay), or an error
+    // found before any transfer, delivered from the event loop once it is
+    // due
+    struct Ready {
+        Clock::time_point due;
+        std::unique_ptr<Job> job;
+        Response response;
+        std::exception_ptr error;
+    };
+
+    // a job waiting out its backoff before the next attempt
+    struct Delayed {
+        Clock::time_point due;
+        std::unique_ptr<Job> job;
+    };
+
+    // both called with _mutex held
+    void setDefaultHeader(std::string_view name, std::string_view value);
+    void refreshCredentials();
+
+    void run(std::stop_token stopToken);
+    std::chrono::milliseconds deliverReady();
+    std::chrono::milliseconds startPending();
+    std::chrono::milliseconds startHedges();
+    void start(Job& job, Share* share);
+    void cancel(Job& job);
+    void failRunning(std::exception_ptr error);
+    void finish(CURL* easy, CURLcode code);
+    void settle(Job& job, Response response, std::exception_ptr error);
+    void deliver(Job& job, Response response);
+    void fail(Job& job, std::exception_ptr error);
+    void failLater(std::unique_ptr<Job> job, std::exception_ptr error);
+
+    MultiHandle _multi;
+    BufferPool _buffers;
+    std::vector<Handle> _idleHandles;
+    std::unordered_map<Job*, std::unique_ptr<Job>> _active;
+    std::map<CURL*, std::unique_ptr<Attempt>> _running;
+
+    std::mutex _mutex;
+    std::array<std::deque<std::unique_ptr<Job>>, 3> _pending;
+    std::vector<Ready> _ready;
+    std::vector<Delayed> _delayed;
+    std::unordered_map<std::string, std::vector<std::unique_ptr<Job>>>
+        _inFlight;
+    Share* _share = nullptr;
+    RateLimiter* _rateLimiter = nullptr;
+    Cache* _cache = nullptr;
+    Executor* _executor = nullptr;
+    Metrics* _metrics = nullptr;
+    Cassette* _cassette = nullptr;
+    const RetryPolicy* _retryPolicy = nullptr;
+    const Credentials* _credentials = nullptr;
+    uint64_t _credentialsVersion = 0;
+    std::shared_ptr<const Defaults> _defaults = std::make_shared<Defaults>();
+
+    std::jthread _thread;
+};
+
+} // namespace http
\ No newline at end of file
@@ -0,0 +1,317 @@
+#pragma once
+
+#include <http.hpp>
+#include <http/multi.hpp>
+#include <http/sink.hpp>
+
+#include <error.hpp>
+
+#include <nlohmann/json.hpp>
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace http {
+
+template <class T>
+struct Page {
+    std::vector<T> items;
+    size_t total = 0;
+};
+
+Page<nlohmann::json> jsonPage(std::string_view body);
+
+// Parses one page while it downloads; page() is called once it has been
+// written in full. A parser that can rewind() lets a page that failed
+// partway be retried.
+template <class T>
+class PageParser : public Sink {
+public:
+    virtual Page<T> page() = 0;
+};
+
+template <class T>
+class PageStream {
+public:
+    using Decoder = std::function<Page<T>(std::string_view body)>;
+    using ParserFactory = std::function<std::unique_ptr<PageParser<T>>()>;
+
+    class Iterator {
+    public:
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+
+        Iterator() = default;
+
+        explicit Iterator(PageStream* stream)
+            : _stream(stream)
+        {
+            ++*this;
+        }
+
+        T& operator*() const
+        {
+            return *_item;
+        }
+
+        T* operator->() const
+        {
+            return &*_item;
+        }
+
+        Iterator& operator++()
+        {
+            _item = _stream->next();
+            if (!_item) {
+                _stream = nullptr;
+            }
+            return *this;
+        }
+
+        void operator++(int)
+        {
+            ++*this;
+        }
+
+        bool operator==(std::default_sentinel_t) const
+        {
+            return _stream == nullptr;
+        }
+
+    private:
+        PageStream* _stream = nullptr;
+        mutable std::optional<T> _item;
+    };
+
+    // each page is buffered whole and then handed to `decoder`
+    PageStream(
+        MultiSession& session,
+        Request request,
+        Decoder decoder,
+        size_t inFlight = 8,
+        size_t pageSize = 20)
+        : PageStream(
+            session,
+            std::move(request),
+            [decoder = std::move(decoder)] {
+                return std::make_unique<BufferedParser>(decoder);
+            },
+            inFlight,
+            pageSize)
+    { }
+
+    // each page is written into a fresh parser as it downloads
+    PageStream(
+        MultiSession& session,
+        Request request,
+        ParserFactory parsers,
+        size_t inFlight = 8,
+        size_t pageSize = 20)
+        : _session(session)
+        , _request(std::move(request))
+        , _parsers(std::move(parsers))
+        , _maxInFlight(inFlight)
+        , _pageSize(pageSize)
+    {
+        e::require(_maxInFlight > 0 && _pageSize > 0);
+        auto pages = std::vector<size_t>{};
+        {
+            auto lock = std::lock_guard{_mutex};
+            pages = claimPages();
+        }
+        fetch(pages);
+    }
+
+    ~PageStream()
+    {
+        auto lock = std::unique_lock{_mutex};
+        _stopped = true;
+        _changed.wait(lock, [this] { return _inFlight == 0; });
+    }
+
+    PageStream(const PageStream&) = delete;
+    PageStream(PageStream&&) = delete;
+    PageStream& operator=(const PageStream&) = delete;
+    PageStream& operator=(PageStream&&) = delete;
+
+    std::optional<T> next()
+    {
+        auto lock = std::unique_lock{_mutex};
+        _changed.wait(lock, [this] {
+            return !_items.empty() || _error || _inFlight == 0;
+        });
+
+        if (_error) {
+            std::rethrow_exception(_error);
+        }
+        if (_items.empty()) {
+            return std::nullopt;
+        }
+
+        auto item = std::move(_items.front());
+        _items.pop_front();
+        return item;
+    }
+
+    Iterator begin()
+    {
+        return Iterator{this};
+    }
+
+    std::default_sentinel_t end()
+    {
+        return std::default_sentinel;
+    }
+
+private:
+    class BufferedParser : public PageParser<T> {
+    public:
+        explicit BufferedParser(Decoder decoder)
+            : _decoder(std::move(decoder))
+        { }
+
+        void expect(size_t contentLength) override
+        {
+            _body.reserve(contentLength);
+        }
+
+        void write(std::string_view chunk) override
+        {
+            _body += chunk;
+        }
+
+        bool rewind() override
+        {
+            _body.clear();
+            return true;
+        }
+
+        Page<T> page() override
+        {
+            return _decoder(_body);
+        }
+
+    private:
+        Decoder _decoder;
+        std::string _body;
+    };
+
+    // the pages to fetch next, counted as in flight already; called with
+    // _mutex held
+    std::vector<size_t> claimPages()
+    {
+        auto pages = std::vector<size_t>{};
+        while (!_stopped && !_error &&
+                _inFlight < _maxInFlight && _nextPage <= _pageCount) {
+            pages.push_back(_nextPage++);
+            _inFlight++;
+        }
+        return pages;
+    }
+
+    // called without _mutex held, as the callbacks of the requests take it
+    void fetch(const std::vector<size_t>& pages)
+    {
+        for (auto page : pages) {
+            try {
+                fetch(page);
+            } catch (...) {
+                onError(std::current_exception());
+            }
+        }
+    }
+
+    void fetch(size_t page)
+    {
+        auto request = _request;
+        request.params["page"] = std::to_string(page);
+        request.params["limit"] = std::to_string(_pageSize);
+
+        // the parser must outlive the transfer, so the callback owns it
+        auto parser = std::shared_ptr<PageParser<T>>{_parsers()};
+        request.sink = parser.get();
+
+        _session.submit(
+            std::move(request),
+            [this, page, parser] (Response response) {
+                onPage(page, *parser, std::move(response));
+            },
+            [this] (std::exception_ptr error) {
+                onError(std::move(error));
+            });
+    }
+
+    void onPage(size_t page, PageParser<T>& parser, Response response)
+    {
+        auto decoded = Page<T>{};
+        try {
+            if (response.code >= 400) {
+                throw e::Error{} << "HTTP " << response.code << " for page " <<
+                    page << " of " << _request.url << ": " << response.contents;
+            }
+            decoded = parser.page();
+        } catch (...) {
+            onError(std::current_exception());
+            return;
+        }
+
+        auto pages = std::vector<size_t>{};
+        {
+            auto lock = std::lock_guard{_mutex};
+            if (page == 1) {
+                _pageCount = std::max<size_t>(
+                    1, (decoded.total + _pageSize - 1) / _pageSize);
+            }
+            for (auto& item : decoded.items) {
+                _items.push_back(std::move(item));
+            }
+            _inFlight--;
+            pages = claimPages();
+            _changed.notify_all();
+        }
+
+        // with no pages claimed the stream may already be destroyed
+        if (!pages.empty()) {
+            fetch(pages);
+        }
+    }
+
+    void onError(std::exception_ptr error)
+    {
+        auto lock = std::lock_guard{_mutex};
+        if (!_error) {
+            _error = std::move(error);
+        }
+        _inFlight--;
+        _changed.notify_all();
+    }
+
+    MultiSession& _session;
+    Request _request;
+    ParserFactory _parsers;
+    size_t _maxInFlight = 0;
+    size_t _pageSize = 0;
+
+    std::mutex _mutex;
+    std::condition_variable _changed;
+    std::deque<T> _items;
+    size_t _nextPage = 1;
+    size_t _pageCount = 1;
+    size_t _inFlight = 0;
+    bool _stopped = false;
+    std::exception_ptr _error;
+};
+
+} // namespace http
\ No newline at end of file
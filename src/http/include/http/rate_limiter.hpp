@@ -0,0 +1,39 @@
+#pragma once
+
+#include <http.hpp>
+
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+
+namespace http {
+
+class RateLimiter {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    explicit RateLimiter(double ratePerSecond = 2.0, double burst = 30.0);
+
+    void acquire(Priority priority = Priority::Normal);
+    bool tryAcquire(Priority priority = Priority::Normal);
+    Clock::time_point nextAvailable() const;
+
+    void update(const Response& response);
+
+private:
+    void refill(Clock::time_point now);
+    bool mayTake(Priority priority, Clock::time_point now) const;
+    Clock::time_point nextAvailableLocked() const;
+
+    mutable std::mutex _mutex;
+    std::condition_variable _tokenReleased;
+    double _rate = 0.0;
+    double _burst = 0.0;
+    double _tokens = 0.0;
+    Clock::time_point _lastRefill;
+    Clock::time_point _pausedUntil;
+    std::array<int, 3> _waiting{};
+};
+
+} // namespace http
\ No newline at end of file
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <http.hpp>
+
+#include <curl/curl.h>
+
+#include <chrono>
+#include <cstdint>
+
+namespace http {
+
+// When and how often a failed request is tried again. Only GETs are
+// retried, as they are idempotent. A GET that streams into a sink is only
+// retried if nothing reached the sink yet (error statuses never do) or the
+// sink can rewind. Every attempt takes a token from the session's rate
+// limiter like any other request.
+struct RetryPolicy {
+    int maxAttempts = 3;
+    std::chrono::milliseconds baseDelay{250};
+    std::chrono::milliseconds maxDelay{10'000};
+
+    // MultiSession only: once a GET without a sink has been running for
+    // longer than this
+    // percentile of its endpoint's total time (see useMetrics()), a second
+    // copy is started and whichever answers first wins. A hedge is only
+    // sent if the rate limiter has a token to spare right away.
+    bool hedge = false;
+    double hedgePercentile = 95.0;
+    std::chrono::milliseconds minHedgeDelay{50};
+    uint64_t minHedgeSamples = 20;
+
+    bool isRetryable(const Request& request) const;
+    bool isTransient(CURLcode code) const;
+    bool isTransient(const Response& response) const;
+
+    // exponential backoff with jitter before attempt number `attempt` + 1,
+    // never shorter than the response's Retry-After
+    std::chrono::milliseconds delay(
+        int attempt, const Response* response = nullptr) const;
+};
+
+} // namespace http
\ No newline at end of file
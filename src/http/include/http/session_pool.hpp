@@ -0,0 +1,67 @@
+#pragma once
+
+#include <http.hpp>
+#include <http/share.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace http {
+
+// Sessions for many threads. Every thread that makes a request through the
+// pool gets a session of its own, copied from the prototype, so a handle is
+// never used by two threads. The sessions share DNS and TLS session
+// caches; each keeps its own connections, since libcurl cannot share those
+// between threads that run at the same time.
+class SessionPool {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    struct ThreadStats {
+        double utilization() const;
+
+        std::thread::id thread;
+        uint64_t requests = 0;
+        std::chrono::microseconds busy{};
+        std::chrono::microseconds lifetime{};
+    };
+
+    SessionPool();
+    ~SessionPool();
+
+    SessionPool(const SessionPool&) = delete;
+    SessionPool(SessionPool&&) = delete;
+    SessionPool& operator=(const SessionPool&) = delete;
+    SessionPool& operator=(SessionPool&&) = delete;
+
+    // The configuration new sessions are copied from. Set it up before
+    // the first request: sessions that already exist keep theirs.
+    Session& prototype();
+
+    Response operator()(Request request);
+    void recycle(Response&& response);
+
+    // this thread's session, created on first use
+    Session& session();
+
+    std::vector<ThreadStats> stats() const;
+    Share::Stats shareStats() const;
+
+private:
+    struct Slot;
+
+    Slot& slot();
+
+    Share _share{Share::Dns | Share::TlsSessions};
+    Session _prototype;
+    const uint64_t _id;
+
+    mutable std::mutex _mutex;
+    std::vector<std::unique_ptr<Slot>> _slots;
+};
+
+} // namespace http
\ No newline at end of file
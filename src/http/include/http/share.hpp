@@ -0,0 +1,60 @@
+#pragma once
+
+#include <http/curl.hpp>
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+
+namespace http {
+
+class Share {
+public:
+    enum Data : unsigned {
+        Dns = 1 << 0,
+        TlsSessions = 1 << 1,
+        // libcurl does not support using a shared connection cache from
+        // several threads at the same time: only for a share whose handles
+        // all run on one thread
+        Connections = 1 << 2,
+    };
+
+    struct Stats {
+        double reuseRate() const;
+
+        uint64_t transfers = 0;
+        uint64_t reusedConnections = 0;
+        uint64_t newConnections = 0;
+    };
+
+    explicit Share(unsigned data = Dns | TlsSessions);
+
+    Share(const Share&) = delete;
+    Share(Share&&) = delete;
+    Share& operator=(const Share&) = delete;
+    Share& operator=(Share&&) = delete;
+
+    // DNS and TLS sessions only, safe for handles on any thread
+    static Share& global();
+
+    CURLSH* ptr();
+
+    void record(Handle& handle);
+    Stats stats() const;
+
+private:
+    static void lock(CURL*, curl_lock_data data, curl_lock_access, void* share);
+    static void unlock(CURL*, curl_lock_data data, void* share);
+
+    std::unique_ptr<CURLSH, CURLSHcode(*)(CURLSH*)> _ptr{
+        nullptr, curl_share_cleanup};
+    std::array<std::mutex, CURL_LOCK_DATA_LAST> _mutexes;
+
+    std::atomic<uint64_t> _transfers = 0;
+    std::atomic<uint64_t> _reusedConnections = 0;
+    std::atomic<uint64_t> _newConnections = 0;
+};
+
+} // namespace http
\ No newline at end of file
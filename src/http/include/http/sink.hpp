@@ -0,0 +1,24 @@
+#pragma once
+
+#include <cstddef>
+#include <string_view>
+
+namespace http {
+
+class Sink {
+public:
+    virtual ~Sink() = default;
+
+    virtual void expect(size_t /*contentLength*/) { }
+    virtual void write(std::string_view chunk) = 0;
+    virtual void finish() { }
+
+    // Goes back to before the first write, so that a request that failed
+    // partway can be retried into the sink; false if it cannot.
+    virtual bool rewind()
+    {
+        return false;
+    }
+};
+
+} // namespace http
\ No newline at end of file
@@ -0,0 +1,225 @@
+#pragma once
+
+#include <condition_variable>
+#include <coroutine>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <optional>
+#include <utility>
+
+namespace http {
+
+template <class T = void>
+class Task;
+
+namespace detail {
+
+class PromiseBase {
+public:
+    struct FinalAwaiter {
+        bool await_ready() const noexcept
+        {
+            return false;
+        }
+
+        template <class Promise>
+        std::coroutine_handle<> await_suspend(
+            std::coroutine_handle<Promise> handle) const noexcept
+        {
+            if (auto continuation = handle.promise()._continuation) {
+                return continuation;
+            }
+            return std::noop_coroutine();
+        }
+
+        void await_resume() const noexcept { }
+    };
+
+    std::suspend_always initial_suspend() const noexcept
+    {
+        return {};
+    }
+
+    FinalAwaiter final_suspend() const noexcept
+    {
+        return {};
+    }
+
+    void unhandled_exception() noexcept
+    {
+        _error = std::current_exception();
+    }
+
+    void continueWith(std::coroutine_handle<> continuation) noexcept
+    {
+        _continuation = continuation;
+    }
+
+protected:
+    void rethrowError() const
+    {
+        if (_error) {
+            std::rethrow_exception(_error);
+        }
+    }
+
+private:
+    std::coroutine_handle<> _continuation;
+    std::exception_ptr _error;
+};
+
+template <class T>
+class Promise : public PromiseBase {
+public:
+    Task<T> get_return_object() noexcept;
+
+    template <class U>
+    void return_value(U&& value)
+    {
+        _value.emplace(std::forward<U>(value));
+    }
+
+    T result()
+    {
+        rethrowError();
+        return std::move(*_value);
+    }
+
+private:
+    std::optional<T> _value;
+};
+
+template <>
+class Promise<void> : public PromiseBase {
+public:
+    Task<void> get_return_object() noexcept;
+
+    void return_void() const noexcept { }
+
+    void result() const
+    {
+        rethrowError();
+    }
+};
+
+} // namespace detail
+
+// A lazily started coroutine. It runs when awaited, and resumes its awaiter
+// directly when it finishes.
+template <class T>
+class [[nodiscard]] Task {
+public:
+    using promise_type = detail::Promise<T>;
+
+    Task() = default;
+
+    explicit Task(std::coroutine_handle<promise_type> handle)
+        : _handle(handle)
+    { }
+
+    Task(const Task&) = delete;
+    Task& operator=(const Task&) = delete;
+
+    Task(Task&& other) noexcept
+        : _handle(std::exchange(other._handle, nullptr))
+    { }
+
+    Task& operator=(Task&& other) noexcept
+    {
+        if (this != &other) {
+            if (_handle) {
+                _handle.destroy();
+            }
+            _handle = std::exchange(other._handle, nullptr);
+        }
+        return *this;
+    }
+
+    ~Task()
+    {
+        if (_handle) {
+            _handle.destroy();
+        }
+    }
+
+    auto operator co_await() && noexcept
+    {
+        struct Awaiter {
+            bool await_ready() const noexcept
+            {
+                return !handle || handle.done();
+            }
+
+            std::coroutine_handle<> await_suspend(
+                std::coroutine_handle<> awaiting) const noexcept
+            {
+                handle.promise().continueWith(awaiting);
+                return handle;
+            }
+
+            T await_resume() const
+            {
+                return handle.promise().result();
+            }
+
+            std::coroutine_handle<promise_type> handle;
+        };
+
+        return Awaiter{_handle};
+    }
+
+private:
+    std::coroutine_handle<promise_type> _handle;
+};
+
+namespace detail {
+
+template <class T>
+Task<T> Promise<T>::get_return_object() noexcept
+{
+    return Task<T>{std::coroutine_handle<Promise<T>>::from_promise(*this)};
+}
+
+inline Task<void> Promise<void>::get_return_object() noexcept
+{
+    return Task<void>{std::coroutine_handle<Promise<void>>::from_promise(*this)};
+}
+
+} // namespace detail
+
+// Resumes coroutines on the thread that calls poll() or run(), so request
+// chains can be driven from an existing loop (e.g. a frame loop) without a
+// thread per chain. post() may be called from any thread.
+class Executor {
+public:
+    Executor() = default;
+
+    Executor(const Executor&) = delete;
+    Executor(Executor&&) = delete;
+    Executor& operator=(const Executor&) = delete;
+    Executor& operator=(Executor&&) = delete;
+
+    void spawn(Task<void> task);
+    void post(std::coroutine_handle<> handle);
+
+    size_t poll();
+    void run();
+
+    size_t active() const;
+
+private:
+    struct Detached;
+
+    Detached launch(Task<void> task);
+    void finished(std::exception_ptr error);
+
+    mutable std::mutex _mutex;
+    std::condition_variable _wake;
+    std::deque<std::coroutine_handle<>> _ready;
+    std::deque<std::exception_ptr> _errors;
+    size_t _active = 0;
+};
+
+} // namespace http
\ No newline at end of file
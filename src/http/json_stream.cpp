@@ -0,0 +1,463 @@
+#include <http/json_stream.hpp>
+
+#include <error.hpp>
+
+#include <charconv>
+#include <system_error>
+
+namespace http {
+
+namespace {
+
+bool isWhitespace(char c)
+{
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+bool isNumberChar(char c)
+{
+    return (c >= '0' && c <= '9') ||
+        c == '-' || c == '+' || c == '.' || c == 'e' || c == 'E';
+}
+
+bool isDigit(char c)
+{
+    return c >= '0' && c <= '9';
+}
+
+// -?(0|[1-9][0-9]*)(\.[0-9]+)?([eE][+-]?[0-9]+)?, as RFC 8259 has it;
+// from_chars alone would take "01", "1." and ".5"
+bool isJsonNumber(std::string_view token)
+{
+    size_t i = 0;
+    auto digits = [&token, &i] {
+        size_t start = i;
+        while (i < token.size() && isDigit(token[i])) {
+            i++;
+        }
+        return i > start;
+    };
+
+    if (i < token.size() && token[i] == '-') {
+        i++;
+    }
+    if (i < token.size() && token[i] == '0') {
+        i++;
+    } else if (!digits()) {
+        return false;
+    }
+    if (i < token.size() && token[i] == '.') {
+        i++;
+        if (!digits()) {
+            return false;
+        }
+    }
+    if (i < token.size() && (token[i] == 'e' || token[i] == 'E')) {
+        i++;
+        if (i < token.size() && (token[i] == '+' || token[i] == '-')) {
+            i++;
+        }
+        if (!digits()) {
+            return false;
+        }
+    }
+    return i == token.size();
+}
+
+bool isLiteralChar(char c)
+{
+    return c >= 'a' && c <= 'z';
+}
+
+int hexValue(char c)
+{
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    if (c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    }
+    if (c >= 'A' && c <= 'F') {
+        return c - 'A' + 10;
+    }
+    return -1;
+}
+
+void appendUtf8(std::string& string, uint32_t codepoint)
+{
+    if (codepoint < 0x80) {
+        string += static_cast<char>(codepoint);
+    } else if (codepoint < 0x800) {
+        string += static_cast<char>(0xC0 | (codepoint >> 6));
+        string += static_cast<char>(0x80 | (codepoint & 0x3F));
+    } else if (codepoint < 0x10000) {
+        string += static_cast<char>(0xE0 | (codepoint >> 12));
+        string += static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F));
+        string += static_cast<char>(0x80 | (codepoint & 0x3F));
+    } else {
+        string += static_cast<char>(0xF0 | (codepoint >> 18));
+        string += static_cast<char>(0x80 | ((codepoint >> 12) & 0x3F));
+        string += static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F));
+        string += static_cast<char>(0x80 | (codepoint & 0x3F));
+    }
+}
+
+template <class T>
+bool parseNumber(const std::string& token, T& value)
+{
+    const char* end = token.data() + token.size();
+    auto [ptr, ec] = std::from_chars(token.data(), end, value);
+    return ec == std::errc{} && ptr == end;
+}
+
+} // namespace
+
+JsonStream::JsonStream(nlohmann::json::json_sax_t& handler)
+    : _handler(handler)
+{ }
+
+void JsonStream::write(std::string_view chunk)
+{
+    if (_aborted) {
+        return;
+    }
+
+    size_t i = 0;
+    while (i < chunk.size() && _expect != Expect::Done) {
+        const char c = chunk[i];
+
+        switch (_lexeme) {
+            case Lexeme::String:
+            {
+                size_t stop = i;
+                while (stop < chunk.size() && chunk[stop] != '"' &&
+                        chunk[stop] != '\\' &&
+                        static_cast<unsigned char>(chunk[stop]) >= 0x20) {
+                    stop++;
+                }
+                if (_highSurrogate != 0 && stop != i) {
+                    throw e::Error{} << "unpaired UTF-16 surrogate in JSON at " <<
+                        _offset + i;
+                }
+                _token.append(chunk.substr(i, stop - i));
+                i = stop;
+                if (i < chunk.size()) {
+                    if (static_cast<unsigned char>(chunk[i]) < 0x20) {
+                        throw e::Error{} <<
+                            "control character in JSON string at " <<
+                            _offset + i;
+                    }
+                    if (chunk[i] == '"') {
+                        if (_highSurrogate != 0) {
+                            throw e::Error{} <<
+                                "unpaired UTF-16 surrogate in JSON at " <<
+                                _offset + i;
+                        }
+                        _lexeme = Lexeme::None;
+                        finishString();
+                    } else {
+                        _lexeme = Lexeme::Escape;
+                    }
+                    i++;
+                }
+                break;
+            }
+
+            case Lexeme::Escape:
+                _lexeme = Lexeme::String;
+                if (_highSurrogate != 0 && c != 'u') {
+                    throw e::Error{} << "unpaired UTF-16 surrogate in JSON at " <<
+                        _offset + i;
+                }
+                switch (c) {
+                    case '"': _token += '"'; break;
+                    case '\\': _token += '\\'; break;
+                    case '/': _token += '/'; break;
+                    case 'b': _token += '\b'; break;
+                    case 'f': _token += '\f'; break;
+                    case 'n': _token += '\n'; break;
+                    case 'r': _token += '\r'; break;
+                    case 't': _token += '\t'; break;
+                    case 'u':
+                        _lexeme = Lexeme::Unicode;
+                        _hexDigits = 0;
+                        _codepoint = 0;
+                        break;
+                    default:
+                        throw e::Error{} << "bad escape in JSON at " <<
+                            _offset + i;
+                }
+                i++;
+                break;
+
+            case Lexeme::Unicode:
+            {
+                int digit = hexValue(c);
+                if (digit < 0) {
+                    throw e::Error{} << "bad unicode escape in JSON at " <<
+                        _offset + i;
+                }
+                _codepoint = _codepoint * 16 + static_cast<uint32_t>(digit);
+                if (++_hexDigits == 4) {
+                    _lexeme = Lexeme::String;
+                    finishUnicode(_offset + i);
+                }
+                i++;
+                break;
+            }
+
+            case Lexeme::Number:
+                if (isNumberChar(c)) {
+                    _token += c;
+                    i++;
+                } else {
+                    _lexeme = Lexeme::None;
+                    finishNumber();
+                }
+                break;
+
+            case Lexeme::Literal:
+                if (isLiteralChar(c)) {
+                    _token += c;
+                    i++;
+                } else {
+                    _lexeme = Lexeme::None;
+                    finishLiteral();
+                }
+                break;
+
+            case Lexeme::None:
+                if (!isWhitespace(c)) {
+                    structural(c, _offset + i);
+                }
+                i++;
+                break;
+        }
+    }
+
+    for (; i < chunk.size() && !_aborted; i++) {
+        if (!isWhitespace(chunk[i])) {
+            throw e::Error{} << "trailing data after JSON value at " <<
+                _offset + i;
+        }
+    }
+    _offset += chunk.size();
+}
+
+void JsonStream::finish()
+{
+    if (_aborted) {
+        return;
+    }
+
+    if (_lexeme == Lexeme::Number) {
+        _lexeme = Lexeme::None;
+        finishNumber();
+    } else if (_lexeme == Lexeme::Literal) {
+        _lexeme = Lexeme::None;
+        finishLiteral();
+    }
+
+    if (_expect != Expect::Done || _lexeme != Lexeme::None) {
+        throw e::Error{} << "unexpected end of JSON at " << _offset;
+    }
+}
+
+void JsonStream::structural(char c, size_t position)
+{
+    switch (_expect) {
+        case Expect::FirstValueOrEnd:
+            if (c == ']') {
+                endContainer(c, position);
+                return;
+            }
+            startValue(c, position);
+            return;
+
+        case Expect::Value:
+            startValue(c, position);
+            return;
+
+        case Expect::FirstKeyOrEnd:
+            if (c == '}') {
+                endContainer(c, position);
+                return;
+            }
+            [[fallthrough]];
+
+        case Expect::Key:
+            if (c != '"') {
+                break;
+            }
+            _lexeme = Lexeme::String;
+            _stringIsKey = true;
+            _token.clear();
+            return;
+
+        case Expect::Colon:
+            if (c != ':') {
+                break;
+            }
+            _expect = Expect::Value;
+            return;
+
+        case Expect::CommaOrEnd:
+            if (c == ',') {
+                _expect =
+                    _containers.back() == '{' ? Expect::Key : Expect::Value;
+                return;
+            }
+            if (c == '}' || c == ']') {
+                endContainer(c, position);
+                return;
+            }
+            break;
+
+        case Expect::Done:
+            break;
+    }
+
+    throw e::Error{} << "unexpected '" << c << "' in JSON at " << position;
+}
+
+void JsonStream::startValue(char c, size_t position)
+{
+    if (c == '{') {
+        _containers.push_back('{');
+        _expect = Expect::FirstKeyOrEnd;
+        accept(_handler.start_object(static_cast<size_t>(-1)));
+    } else if (c == '[') {
+        _containers.push_back('[');
+        _expect = Expect::FirstValueOrEnd;
+        accept(_handler.start_array(static_cast<size_t>(-1)));
+    } else if (c == '"') {
+        _lexeme = Lexeme::String;
+        _stringIsKey = false;
+        _token.clear();
+    } else if (c == '-' || isDigit(c)) {
+        _lexeme = Lexeme::Number;
+        _token.assign(1, c);
+        _tokenStart = position;
+    } else if (isLiteralChar(c)) {
+        _lexeme = Lexeme::Literal;
+        _token.assign(1, c);
+        _tokenStart = position;
+    } else {
+        throw e::Error{} << "unexpected '" << c << "' in JSON at " << position;
+    }
+}
+
+void JsonStream::afterValue()
+{
+    if (_expect == Expect::Done) {
+        return;
+    }
+    _expect = _containers.empty() ? Expect::Done : Expect::CommaOrEnd;
+}
+
+void JsonStream::endContainer(char c, size_t position)
+{
+    const char open = c == '}' ? '{' : '[';
+    if (_containers.empty() || _containers.back() != open) {
+        throw e::Error{} << "mismatched '" << c << "' in JSON at " <<
+            position;
+    }
+    _containers.pop_back();
+
+    _expect = Expect::CommaOrEnd;
+    accept(c == '}' ? _handler.end_object() : _handler.end_array());
+    afterValue();
+}
+
+void JsonStream::finishString()
+{
+    if (_stringIsKey) {
+        _expect = Expect::Colon;
+        accept(_handler.key(_token));
+    } else {
+        accept(_handler.string(_token));
+        afterValue();
+    }
+}
+
+void JsonStream::finishNumber()
+{
+    if (!isJsonNumber(_token)) {
+        throw e::Error{} << "bad number '" << _token << "' in JSON at " <<
+            _tokenStart;
+    }
+
+    // integers that do not fit 64 bits are read as floats, as
+    // nlohmann::json::parse does
+    if (_token.find_first_of(".eE") == std::string::npos) {
+        if (_token.front() == '-') {
+            auto value = nlohmann::json::number_integer_t{};
+            if (parseNumber(_token, value)) {
+                accept(_handler.number_integer(value));
+                afterValue();
+                return;
+            }
+        } else {
+            auto value = nlohmann::json::number_unsigned_t{};
+            if (parseNumber(_token, value)) {
+                accept(_handler.number_unsigned(value));
+                afterValue();
+                return;
+            }
+        }
+    }
+
+    auto value = nlohmann::json::number_float_t{};
+    if (!parseNumber(_token, value)) {
+        throw e::Error{} << "bad number '" << _token << "' in JSON at " <<
+            _tokenStart;
+    }
+    accept(_handler.number_float(value, _token));
+    afterValue();
+}
+
+void JsonStream::finishLiteral()
+{
+    if (_token == "true") {
+        accept(_handler.boolean(true));
+    } else if (_token == "false") {
+        accept(_handler.boolean(false));
+    } else if (_token == "null") {
+        accept(_handler.null());
+    } else {
+        throw e::Error{} << "bad literal '" << _token << "' in JSON at " <<
+            _tokenStart;
+    }
+    afterValue();
+}
+
+void JsonStream::finishUnicode(size_t position)
+{
+    if (_highSurrogate != 0) {
+        if (_codepoint < 0xDC00 || _codepoint > 0xDFFF) {
+            throw e::Error{} << "unpaired UTF-16 surrogate in JSON at " <<
+                position;
+        }
+        appendUtf8(
+            _token,
+            0x10000 + ((_highSurrogate - 0xD800) << 10) + (_codepoint - 0xDC00));
+        _highSurrogate = 0;
+    } else if (_codepoint >= 0xD800 && _codepoint <= 0xDBFF) {
+        _highSurrogate = _codepoint;
+    } else if (_codepoint >= 0xDC00 && _codepoint <= 0xDFFF) {
+        throw e::Error{} << "unpaired UTF-16 surrogate in JSON at " <<
+            position;
+    } else {
+        appendUtf8(_token, _codepoint);
+    }
+}
+
+void JsonStream::accept(bool result)
+{
+    if (!result) {
+        _expect = Expect::Done;
+        _aborted = true;
+    }
+}
+
+} // namespace http
\ No newline at end of file
@@ -0,0 +1,319 @@
+#include <http/metrics.hpp>
+
+#include "storage.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <format>
+#include <memory>
+
+namespace http {
+
+namespace {
+
+constexpr auto phases = std::array{
+    Metrics::Phase::NameLookup,
+    Metrics::Phase::Connect,
+    Metrics::Phase::Tls,
+    Metrics::Phase::Wait,
+    Metrics::Phase::Transfer,
+    Metrics::Phase::Total,
+};
+
+std::chrono::microseconds since(
+    std::chrono::microseconds end, std::chrono::microseconds start)
+{
+    return std::max(end - start, std::chrono::microseconds{0});
+}
+
+double milliseconds(std::chrono::microseconds duration)
+{
+    return static_cast<double>(duration.count()) / 1000.0;
+}
+
+} // namespace
+
+void Histogram::record(std::chrono::microseconds value) noexcept
+{
+    const auto limit = (uint64_t{1} << maxValueBits) - 1;
+    const auto v = std::min(
+        static_cast<uint64_t>(std::max<int64_t>(value.count(), 0)), limit);
+
+    _buckets[bucket(v)].fetch_add(1, std::memory_order_relaxed);
+    _count.fetch_add(1, std::memory_order_relaxed);
+    _sum.fetch_add(v, std::memory_order_relaxed);
+
+    auto max = _max.load(std::memory_order_relaxed);
+    while (v > max &&
+        !_max.compare_exchange_weak(max, v, std::memory_order_relaxed)) { }
+}
+
+uint64_t Histogram::count() const noexcept
+{
+    return _count.load(std::memory_order_relaxed);
+}
+
+std::chrono::microseconds Histogram::max() const noexcept
+{
+    return std::chrono::microseconds{
+        static_cast<int64_t>(_max.load(std::memory_order_relaxed))};
+}
+
+std::chrono::microseconds Histogram::mean() const noexcept
+{
+    auto count = this->count();
+    if (count == 0) {
+        return {};
+    }
+    return std::chrono::microseconds{static_cast<int64_t>(
+        _sum.load(std::memory_order_relaxed) / count)};
+}
+
+std::chrono::microseconds Histogram::percentile(double percent) const noexcept
+{
+    auto count = this->count();
+    if (count == 0) {
+        return {};
+    }
+
+    auto target = static_cast<uint64_t>(
+        std::ceil(std::clamp(percent, 0.0, 100.0) / 100.0 *
+            static_cast<double>(count)));
+    target = std::max<uint64_t>(target, 1);
+
+    auto seen = uint64_t{0};
+    for (size_t i = 0; i < bucketCount; i++) {
+        seen += _buckets[i].load(std::memory_order_relaxed);
+        if (seen >= target) {
+            return std::min(
+                std::chrono::microseconds{
+                    static_cast<int64_t>(highestInBucket(i))},
+                max());
+        }
+    }
+    return max();
+}
+
+size_t Histogram::bucket(uint64_t value) noexcept
+{
+    constexpr auto subBuckets = uint64_t{1} << subBucketBits;
+    if (value < 2 * subBuckets) {
+        return static_cast<size_t>(value);
+    }
+    const auto shift = std::bit_width(value) - 1 - subBucketBits;
+    const auto top = value >> shift;
+    return static_cast<size_t>((shift + 1) * subBuckets + (top - subBuckets));
+}
+
+uint64_t Histogram::highestInBucket(size_t bucket) noexcept
+{
+    constexpr auto subBuckets = size_t{1} << subBucketBits;
+    if (bucket < 2 * subBuckets) {
+        return bucket;
+    }
+    const auto shift = bucket / subBuckets - 1;
+    const auto top = uint64_t{subBuckets + bucket % subBuckets};
+    return ((top + 1) << shift) - 1;
+}
+
+Metrics::Endpoint::Endpoint(std::string name)
+    : _name(std::move(name))
+{ }
+
+const std::string& Metrics::Endpoint::name() const
+{
+    return _name;
+}
+
+const Histogram& Metrics::Endpoint::histogram(Phase phase) const
+{
+    return _histograms.at(static_cast<size_t>(phase));
+}
+
+uint64_t Metrics::Endpoint::bytesReceived() const
+{
+    return _bytesReceived.load(std::memory_order_relaxed);
+}
+
+uint64_t Metrics::Endpoint::bytesSent() const
+{
+    return _bytesSent.load(std::memory_order_relaxed);
+}
+
+Metrics::~Metrics()
+{
+    for (auto& slot : _slots) {
+        delete slot.load();
+    }
+}
+
+void Metrics::record(const Request& request, const Response& response)
+{
+    auto buffer = Name{};
+    auto& endpoint = findOrInsert(endpointName(request, buffer));
+
+    // libcurl reports every phase as the time since the transfer started
+    const auto& t = response.timings;
+    const auto connected = std::max(t.connect, t.appConnect);
+    auto record = [&endpoint] (Phase phase, std::chrono::microseconds value) {
+        endpoint._histograms[static_cast<size_t>(phase)].record(value);
+    };
+    record(Phase::NameLookup, t.nameLookup);
+    record(Phase::Connect, since(t.connect, t.nameLookup));
+    record(Phase::Tls, t.appConnect.count() > 0 ?
+        since(t.appConnect, t.connect) : std::chrono::microseconds{0});
+    record(Phase::Wait, since(t.startTransfer, connected));
+    record(Phase::Transfer, since(t.total, t.startTransfer));
+    record(Phase::Total, t.total);
+
+    endpoint._bytesReceived.fetch_add(
+        static_cast<uint64_t>(std::max<int64_t>(response.bodySize.wire, 0)),
+        std::memory_order_relaxed);
+    endpoint._bytesSent.fetch_add(
+        static_cast<uint64_t>(std::max<int64_t>(response.bodySize.sent, 0)),
+        std::memory_order_relaxed);
+}
+
+const Metrics::Endpoint* Metrics::endpoint(std::string_view name) const
+{
+    return find(name);
+}
+
+const Metrics::Endpoint* Metrics::endpoint(const Request& request) const
+{
+    auto buffer = Name{};
+    return find(endpointName(request, buffer));
+}
+
+std::chrono::microseconds Metrics::percentile(
+    const Request& request, Phase phase, double percent) const
+{
+    if (const auto* endpoint = this->endpoint(request)) {
+        return endpoint->histogram(phase).percentile(percent);
+    }
+    return {};
+}
+
+void Metrics::dump(std::ostream& output) const
+{
+    auto dumpEndpoint = [&output] (const Endpoint& endpoint) {
+        const auto& total = endpoint.histogram(Phase::Total);
+        if (total.count() == 0) {
+            return;
+        }
+
+        output << std::format(
+            "{}: {} requests, {} B received, {} B sent\n",
+            endpoint.name(), total.count(),
+            endpoint.bytesReceived(), endpoint.bytesSent());
+        for (auto phase : phases) {
+            const auto& histogram = endpoint.histogram(phase);
+            output << "  " << phase << std::format(
+                ": p50 {:.1f} ms, p90 {:.1f} ms, p99 {:.1f} ms, max {:.1f} ms\n",
+                milliseconds(histogram.percentile(50)),
+                milliseconds(histogram.percentile(90)),
+                milliseconds(histogram.percentile(99)),
+                milliseconds(histogram.max()));
+        }
+    };
+
+    for (const auto& slot : _slots) {
+        if (const auto* endpoint = slot.load(std::memory_order_acquire)) {
+            dumpEndpoint(*endpoint);
+        }
+    }
+    dumpEndpoint(_overflow);
+}
+
+std::string_view Metrics::endpointName(const Request& request, Name& buffer)
+{
+    size_t size = 0;
+    auto append = [&buffer, &size] (std::string_view string) {
+        auto count = std::min(string.size(), buffer.size() - size);
+        std::ranges::copy(string.substr(0, count), buffer.data() + size);
+        size += count;
+    };
+
+    append(effectiveMethod(request) == Method::POST ? "POST " : "GET ");
+
+    auto path = std::string_view{request.url};
+    if (auto scheme = path.find("://"); scheme != std::string_view::npos) {
+        path.remove_prefix(scheme + 3);
+        auto slash = path.find('/');
+        path.remove_prefix(slash == std::string_view::npos ? path.size() : slash);
+    }
+    path = path.substr(0, path.find('?'));
+
+    while (!path.empty()) {
+        auto slash = path.find('/', 1);
+        auto segment = path.substr(0, slash);
+        path.remove_prefix(segment.size());
+
+        auto name = segment.starts_with('/') ? segment.substr(1) : segment;
+        bool isId = !name.empty() && std::ranges::all_of(name, [] (char c) {
+            return c >= '0' && c <= '9';
+        });
+        if (isId || name.find('-') != std::string_view::npos) {
+            append("/*");
+        } else {
+            append(segment);
+        }
+    }
+    return {buffer.data(), size};
+}
+
+Metrics::Endpoint* Metrics::find(std::string_view name) const
+{
+    const auto start = static_cast<size_t>(fnv1a(name));
+    for (size_t i = 0; i < slotCount; i++) {
+        auto* endpoint =
+            _slots[(start + i) % slotCount].load(std::memory_order_acquire);
+        if (!endpoint) {
+            return nullptr;
+        }
+        if (endpoint->_name == name) {
+            return endpoint;
+        }
+    }
+    return nullptr;
+}
+
+Metrics::Endpoint& Metrics::findOrInsert(std::string_view name)
+{
+    const auto start = static_cast<size_t>(fnv1a(name));
+    auto fresh = std::unique_ptr<Endpoint>{};
+    for (size_t i = 0; i < slotCount; i++) {
+        auto& slot = _slots[(start + i) % slotCount];
+        auto* endpoint = slot.load(std::memory_order_acquire);
+        if (!endpoint) {
+            if (!fresh) {
+                fresh = std::make_unique<Endpoint>(std::string{name});
+            }
+            if (slot.compare_exchange_strong(
+                    endpoint, fresh.get(), std::memory_order_acq_rel)) {
+                return *fresh.release();
+            }
+        }
+        // either occupied all along, or another thread just claimed it
+        if (endpoint->_name == name) {
+            return *endpoint;
+        }
+    }
+    return _overflow;
+}
+
+std::ostream& operator<<(std::ostream& output, Metrics::Phase phase)
+{
+    switch (phase) {
+        case Metrics::Phase::NameLookup: return output << "name lookup";
+        case Metrics::Phase::Connect: return output << "connect";
+        case Metrics::Phase::Tls: return output << "tls";
+        case Metrics::Phase::Wait: return output << "wait";
+        case Metrics::Phase::Transfer: return output << "transfer";
+        case Metrics::Phase::Total: return output << "total";
+    }
+    return output << "unknown phase";
+}
+
+} // namespace http
\ No newline at end of file
@@ -0,0 +1,756 @@
+#include <http/multi.hpp>
+
+#include "transfer.hpp"
+
+#include <algorithm>
+#include <iterator>
+#include <chrono>
+#include <optional>
+#include <utility>
+
+namespace http {
+
+struct MultiSession::Job {
+    Request request;
+    Callback onResponse;
+    ErrorCallback onError;
+    CacheLookup cacheLookup;
+    std::string flightKey;
+    Cassette* cassette = nullptr;
+    std::string cassetteKey;
+    // a sink gets the body as it downloads, or from deliver() when the
+    // response comes from somewhere else
+    Sink* sink = nullptr;
+    bool keepBody = false;
+    bool streamed = false;
+    std::shared_ptr<const Defaults> defaults;
+    const RetryPolicy* retryPolicy = nullptr;
+    bool retry = false;
+    int attempt = 0;
+    int running = 0;
+    std::optional<Clock::time_point> hedgeAt;
+};
+
+// one transfer of a job: normally there is exactly one at a time, a hedged
+// request has two
+struct MultiSession::Attempt {
+    Job* job = nullptr;
+    Handle handle;
+    std::unique_ptr<Transfer> transfer;
+};
+
+MultiSession::MultiSession()
+    : _thread([this] (std::stop_token stopToken) { run(stopToken); })
+{ }
+
+MultiSession::~MultiSession()
+{
+    _thread.request_stop();
+    _multi.wakeup();
+    _thread.join();
+
+    for (auto& [easy, attempt] : _running) {
+        _multi.remove(attempt->handle);
+    }
+}
+
+std::future<Response> MultiSession::submit(Request request)
+{
+    auto promise = std::make_shared<std::promise<Response>>();
+    auto future = promise->get_future();
+    submit(
+        std::move(request),
+        [promise] (Response response) {
+            promise->set_value(std::move(response));
+        },
+        [promise] (std::exception_ptr error) {
+            promise->set_exception(std::move(error));
+        });
+    return future;
+}
+
+void MultiSession::useShare(Share& share)
+{
+    auto lock = std::lock_guard{_mutex};
+    _share = &share;
+}
+
+void MultiSession::useRateLimiter(RateLimiter& rateLimiter)
+{
+    auto lock = std::lock_guard{_mutex};
+    _rateLimiter = &rateLimiter;
+}
+
+void MultiSession::useCache(Cache& cache)
+{
+    auto lock = std::lock_guard{_mutex};
+    _cache = &cache;
+}
+
+void MultiSession::useExecutor(Executor& executor)
+{
+    auto lock = std::lock_guard{_mutex};
+    _executor = &executor;
+}
+
+void MultiSession::useMetrics(Metrics& metrics)
+{
+    auto lock = std::lock_guard{_mutex};
+    _metrics = &metrics;
+}
+
+void MultiSession::useCassette(Cassette& cassette)
+{
+    auto lock = std::lock_guard{_mutex};
+    _cassette = &cassette;
+}
+
+void MultiSession::useRetryPolicy(const RetryPolicy& policy)
+{
+    auto lock = std::lock_guard{_mutex};
+    _retryPolicy = &policy;
+}
+
+void MultiSession::useCredentials(const Credentials& credentials)
+{
+    auto lock = std::lock_guard{_mutex};
+    _credentials = &credentials;
+    _credentialsVersion = 0;
+}
+
+void MultiSession::baseUrl(std::string url)
+{
+    auto lock = std::lock_guard{_mutex};
+    auto defaults = std::make_shared<Defaults>(*_defaults);
+    defaults->baseUrl(std::move(url));
+    _defaults = std::move(defaults);
+}
+
+void MultiSession::defaultHeader(std::string_view name, std::string_view value)
+{
+    auto lock = std::lock_guard{_mutex};
+    setDefaultHeader(name, value);
+}
+
+void MultiSession::setDefaultHeader(
+    std::string_view name, std::string_view value)
+{
+    // requests already submitted keep the defaults they were submitted with
+    auto defaults = std::make_shared<Defaults>(*_defaults);
+    defaults->header(name, value);
+    _defaults = std::move(defaults);
+}
+
+void MultiSession::refreshCredentials()
+{
+    auto version = _credentials->version();
+    if (version == _credentialsVersion) {
+        return;
+    }
+    if (auto authorization = _credentials->authorization()) {
+        setDefaultHeader("Authorization", *authorization);
+    }
+    _credentialsVersion = version;
+}
+
+void MultiSession::submit(
+    Request request, Callback onResponse, ErrorCallback onError)
+{
+    auto job = std::make_unique<Job>(Job{
+        .request = std::move(request),
+        .onResponse = std::move(onResponse),
+        .onError = std::move(onError),
+        .cacheLookup = {},
+        .flightKey = {},
+        .cassette = nullptr,
+        .cassetteKey = {},
+        .sink = nullptr,
+        .keepBody = false,
+        .streamed = false,
+        .defaults = nullptr,
+        .retryPolicy = nullptr,
+        .retry = false,
+        .attempt = 0,
+        .running = 0,
+        .hedgeAt = std::nullopt,
+    });
+
+    Cache* cache = nullptr;
+    Cassette* cassette = nullptr;
+    {
+        auto lock = std::lock_guard{_mutex};
+        cache = _cache;
+        cassette = _cassette;
+        if (_credentials) {
+            refreshCredentials();
+        }
+        job->defaults = _defaults;
+        job->retryPolicy = _retryPolicy;
+    }
+    job->defaults->resolve(job->request);
+    job->sink = job->request.sink;
+    job->retry = job->retryPolicy &&
+        job->retryPolicy->isRetryable(job->request);
+
+    if (cassette) {
+        auto key = Cassette::key(job->request);
+        if (cassette->replaying()) {
+            auto response = Response{};
+            try {
+                response = cassette->replay(key);
+            } catch (...) {
+                failLater(std::move(job), std::current_exception());
+                return;
+            }
+
+            auto due = Clock::now();
+            if (cassette->mode() == Cassette::Mode::ReplayWithLatency) {
+                due += response.timings.total;
+            }
+            {
+                auto lock = std::lock_guard{_mutex};
+                _ready.push_back(Ready{
+                    .due = due,
+                    .job = std::move(job),
+                    .response = std::move(response),
+                    .error = nullptr,
+                });
+            }
+            _multi.wakeup();
+            return;
+        }
+        job->cassette = cassette;
+        job->cassetteKey = std::move(key);
+    }
+
+    // cache hits are still delivered from the event loop thread, so
+    // callbacks never run inside submit()
+    auto cached = std::optional<Response>{};
+    if (cache) {
+        try {
+            cached = cache->prepare(
+                job->request, job->cacheLookup, job->defaults->headers());
+        } catch (...) {
+            failLater(std::move(job), std::current_exception());
+            return;
+        }
+    }
+
+    // a sink request streams its body as it comes and has nothing to share
+    auto flightKey = std::string{};
+    if (!job->sink) {
+        flightKey = cache ?
+            job->cacheLookup.key :
+            requestKey(job->request, job->defaults->headers());
+    }
+    // the cassette and the cache also need the body that went to the sink
+    job->keepBody = job->sink &&
+        (job->cassette || (cache && cache->keeps(job->cacheLookup.key)));
+
+    // retries and hedges reuse the URL encoded here
+    if (job->retry && !job->request.params.empty()) {
+        job->request.url = buildUrl(job->request.url, job->request.params);
+        job->request.params.clear();
+    }
+
+    {
+        auto lock = std::lock_guard{_mutex};
+        if (cached) {
+            _ready.push_back(Ready{
+                .due = Clock::now(),
+                .job = std::move(job),
+                .response = std::move(*cached),
+                .error = nullptr,
+            });
+        } else if (auto it = _inFlight.find(flightKey);
+                !flightKey.empty() && it != _inFlight.end()) {
+            // an identical GET is already on its way: share its response
+            it->second.push_back(std::move(job));
+            return;
+        } else {
+            if (!flightKey.empty()) {
+                _inFlight.try_emplace(flightKey);
+                job->flightKey = std::move(flightKey);
+            }
+            auto priority = std::to_underlying(job->request.priority);
+            _pending.at(priority).push_back(std::move(job));
+        }
+    }
+    _multi.wakeup();
+}
+
+MultiSession::Awaiter MultiSession::async(Request request)
+{
+    auto lock = std::lock_guard{_mutex};
+    return Awaiter{*this, std::move(request), _executor};
+}
+
+MultiSession::Awaiter::Awaiter(
+        MultiSession& session, Request request, Executor* executor)
+    : _session(session)
+    , _request(std::move(request))
+    , _executor(executor)
+{ }
+
+bool MultiSession::Awaiter::await_suspend(std::coroutine_handle<> handle)
+{
+    _handle = handle;
+    _session.submit(
+        std::move(_request),
+        [this] (Response response) {
+            _response = std::move(response);
+            complete();
+        },
+        [this] (std::exception_ptr error) {
+            _error = std::move(error);
+            complete();
+        });
+
+    // the request may complete before submit() returns: whichever side gets
+    // here second continues the coroutine
+    return !_arrived.exchange(true, std::memory_order_acq_rel);
+}
+
+Response MultiSession::Awaiter::await_resume()
+{
+    if (_error) {
+        std::rethrow_exception(_error);
+    }
+    return std::move(_response);
+}
+
+void MultiSession::Awaiter::complete()
+{
+    if (!_arrived.exchange(true, std::memory_order_acq_rel)) {
+        return;
+    }
+
+    if (_executor) {
+        _executor->post(_handle);
+    } else {
+        _handle.resume();
+    }
+}
+
+void MultiSession::recycle(Response&& response)
+{
+    _buffers.release(std::move(response.contents));
+}
+
+void MultiSession::run(std::stop_token stopToken)
+{
+    while (!stopToken.stop_requested()) {
+        try {
+            auto timeout =
+                std::min({deliverReady(), startPending(), startHedges()});
+            _multi.perform();
+            while (CURLMsg* message = _multi.infoRead()) {
+                if (message->msg == CURLMSG_DONE) {
+                    finish(message->easy_handle, message->data.result);
+                }
+            }
+            _multi.poll(timeout);
+        } catch (...) {
+            // a broken multi handle fails the transfers it was running, not
+            // the thread; the pause keeps a persistent error from spinning
+            failRunning(std::current_exception());
+            std::this_thread::sleep_for(std::chrono::milliseconds{100});
+        }
+    }
+}
+
+std::chrono::milliseconds MultiSession::deliverReady()
+{
+    auto due = std::vector<Ready>{};
+    auto timeout = std::chrono::milliseconds{1000};
+    {
+        auto lock = std::lock_guard{_mutex};
+        auto now = Clock::now();
+        auto [waiting, end] = std::ranges::stable_partition(
+            _ready, [now] (const Ready& ready) { return ready.due > now; });
+        due.assign(
+            std::make_move_iterator(waiting), std::make_move_iterator(end));
+        _ready.erase(waiting, end);
+
+        for (const auto& ready : _ready) {
+            timeout = std::min(
+                timeout,
+                std::chrono::ceil<std::chrono::milliseconds>(ready.due - now));
+        }
+    }
+
+    for (auto& ready : due) {
+        if (ready.error) {
+            fail(*ready.job, std::move(ready.error));
+        } else {
+            deliver(*ready.job, std::move(ready.response));
+        }
+    }
+    return timeout;
+}
+
+std::chrono::milliseconds MultiSession::startPending()
+{
+    auto jobs = std::vector<std::unique_ptr<Job>>{};
+    auto timeout = std::chrono::milliseconds{1000};
+    Share* share = nullptr;
+    Metrics* metrics = nullptr;
+    {
+        auto lock = std::lock_guard{_mutex};
+        share = _share;
+        metrics = _metrics;
+
+        // retries that have waited long enough go first in their queue
+        auto now = Clock::now();
+        auto [waiting, end] = std::ranges::stable_partition(
+            _delayed,
+            [now] (const Delayed& delayed) { return delayed.due > now; });
+        for (auto it = waiting; it != end; ++it) {
+            auto priority = std::to_underlying(it->job->request.priority);
+            _pending.at(priority).push_front(std::move(it->job));
+        }
+        _delayed.erase(waiting, end);
+
+        for (const auto& delayed : _delayed) {
+            timeout = std::min(
+                timeout,
+                std::chrono::ceil<std::chrono::milliseconds>(
+                    delayed.due - now));
+        }
+
+        bool throttled = false;
+        for (auto& queue : _pending) {
+            while (!queue.empty() && !throttled) {
+                if (_rateLimiter &&
+                        !_rateLimiter->tryAcquire(queue.front()->request.priority)) {
+                    throttled = true;
+                    break;
+                }
+                jobs.push_back(std::move(queue.front()));
+                queue.pop_front();
+            }
+        }
+
+        if (throttled) {
+            auto untilToken = std::chrono::ceil<std::chrono::milliseconds>(
+                _rateLimiter->nextAvailable() - RateLimiter::Clock::now());
+            timeout = std::clamp(
+                untilToken, std::chrono::milliseconds{1}, timeout);
+        }
+    }
+
+    for (auto& job : jobs) {
+        job->attempt++;
+        try {
+            start(*job, share);
+        } catch (...) {
+            settle(*job, {}, std::current_exception());
+            continue;
+        }
+
+        const auto* policy = job->retryPolicy;
+        job->hedgeAt.reset();
+        // two copies of a request cannot stream into one sink
+        if (job->retry && !job->sink && policy->hedge && metrics) {
+            const auto* endpoint = metrics->endpoint(job->request);
+            if (endpoint) {
+                const auto& total = endpoint->histogram(Metrics::Phase::Total);
+                if (total.count() >= policy->minHedgeSamples) {
+                    auto delay = std::max<std::chrono::milliseconds>(
+                        policy->minHedgeDelay,
+                        std::chrono::ceil<std::chrono::milliseconds>(
+                            total.percentile(policy->hedgePercentile)));
+                    job->hedgeAt = Clock::now() + delay;
+                    timeout = std::min(timeout, delay);
+                }
+            }
+        }
+
+        auto* key = job.get();
+        _active.emplace(key, std::move(job));
+    }
+
+    return timeout;
+}
+
+std::chrono::milliseconds MultiSession::startHedges()
+{
+    auto timeout = std::chrono::milliseconds{1000};
+    Share* share = nullptr;
+    RateLimiter* rateLimiter = nullptr;
+    {
+        auto lock = std::lock_guard{_mutex};
+        share = _share;
+        rateLimiter = _rateLimiter;
+    }
+
+    auto now = Clock::now();
+    for (auto& [key, job] : _active) {
+        if (!job->hedgeAt) {
+            continue;
+        }
+        if (*job->hedgeAt > now) {
+            timeout = std::min(
+                timeout,
+                std::chrono::ceil<std::chrono::milliseconds>(
+                    *job->hedgeAt - now));
+            continue;
+        }
+
+        // a hedge only spends a token that nobody else is waiting for; if
+        // there is none, the request goes without
+        job->hedgeAt.reset();
+        if (rateLimiter && !rateLimiter->tryAcquire(Priority::Background)) {
+            continue;
+        }
+        try {
+            start(*job, share);
+        } catch (...) {
+            // the first copy is still running and will answer
+        }
+    }
+    return timeout;
+}
+
+void MultiSession::start(Job& job, Share* share)
+{
+    bool reuse = !_idleHandles.empty();
+    auto attempt = std::make_unique<Attempt>(Attempt{
+        .job = &job,
+        .handle = reuse ? std::move(_idleHandles.back()) : Handle{},
+        .transfer = nullptr,
+    });
+    if (reuse) {
+        _idleHandles.pop_back();
+    } else {
+        setupHandle(attempt->handle);
+    }
+
+    try {
+        if (share) {
+            attempt->handle.setopt(CURLOPT_SHARE, share->ptr());
+        }
+        // a request that may be sent again keeps its own copy
+        attempt->transfer = std::make_unique<Transfer>(
+            attempt->handle,
+            job.retry ? job.request : std::move(job.request),
+            _buffers.acquire(),
+            job.defaults.get(),
+            job.keepBody);
+        _multi.add(attempt->handle);
+    } catch (...) {
+        attempt->transfer.reset();
+        _idleHandles.push_back(std::move(attempt->handle));
+        throw;
+    }
+
+    CURL* easy = attempt->handle.ptr();
+    _running.emplace(easy, std::move(attempt));
+    job.running++;
+}
+
+void MultiSession::cancel(Job& job)
+{
+    for (auto it = _running.begin(); it != _running.end(); ) {
+        auto& attempt = *it->second;
+        if (attempt.job != &job) {
+            ++it;
+            continue;
+        }
+        _multi.remove(attempt.handle);
+        _buffers.release(attempt.transfer->releaseBuffer());
+        attempt.transfer.reset();
+        _idleHandles.push_back(std::move(attempt.handle));
+        it = _running.erase(it);
+    }
+    job.running = 0;
+}
+
+void MultiSession::failRunning(std::exception_ptr error)
+{
+    for (auto& [easy, attempt] : _running) {
+        try {
+            _multi.remove(attempt->handle);
+        } catch (...) {
+            // the handle is cleaned up below either way
+        }
+    }
+    _running.clear();
+
+    auto jobs = std::exchange(_active, {});
+    for (auto& [key, job] : jobs) {
+        job->running = 0;
+        settle(*job, {}, error);
+    }
+}
+
+void MultiSession::finish(CURL* easy, CURLcode code)
+{
+    auto node = _running.extract(easy);
+    if (!node) {
+        // the losing copy of a hedged request, cancelled after it was done
+        return;
+    }
+    auto& attempt = *node.mapped();
+    auto& job = *attempt.job;
+    job.running--;
+    _multi.remove(attempt.handle);
+
+    Metrics* metrics = nullptr;
+    {
+        auto lock = std::lock_guard{_mutex};
+        if (_share) {
+            _share->record(attempt.handle);
+        }
+        metrics = _metrics;
+    }
+
+    auto response = Response{};
+    auto error = std::exception_ptr{};
+    bool wroteToSink = attempt.transfer->wroteToSink();
+    try {
+        response = attempt.transfer->finish(code);
+        job.streamed = true;
+        if (metrics) {
+            metrics->record(attempt.transfer->request(), response);
+        }
+    } catch (...) {
+        error = std::current_exception();
+        _buffers.release(attempt.transfer->releaseBuffer());
+    }
+    attempt.transfer.reset();
+    _idleHandles.push_back(std::move(attempt.handle));
+
+    Cache* cache = nullptr;
+    bool transient = false;
+    if (error) {
+        transient = job.retry && job.retryPolicy->isTransient(code);
+    } else {
+        auto lock = std::lock_guard{_mutex};
+        if (_rateLimiter) {
+            _rateLimiter->update(response);
+        }
+        cache = _cache;
+        transient = job.retry && job.retryPolicy->isTransient(response);
+    }
+
+    if (transient) {
+        if (job.running > 0) {
+            // the other copy of a hedged request may still get through
+            recycle(std::move(response));
+            return;
+        }
+        // a sink that got part of a failed body has to start over
+        if (job.attempt < job.retryPolicy->maxAttempts &&
+                (!wroteToSink || job.sink->rewind())) {
+            auto delay = job.retryPolicy->delay(
+                job.attempt, error ? nullptr : &response);
+            recycle(std::move(response));
+            auto lock = std::lock_guard{_mutex};
+            _delayed.push_back(Delayed{
+                .due = Clock::now() + delay,
+                .job = std::move(_active.extract(&job).mapped()),
+            });
+            return;
+        }
+    }
+
+    // first answer wins
+    if (job.running > 0) {
+        cancel(job);
+    }
+    if (cache) {
+        try {
+            response = cache->complete(
+                std::move(job.cacheLookup), std::move(response));
+        } catch (...) {
+            error = std::current_exception();
+        }
+    }
+
+    auto owned = std::move(_active.extract(&job).mapped());
+    settle(*owned, std::move(response), error);
+}
+
+void MultiSession::settle(
+    Job& job, Response response, std::exception_ptr error)
+{
+    auto followers = std::vector<std::unique_ptr<Job>>{};
+    if (!job.flightKey.empty()) {
+        auto lock = std::lock_guard{_mutex};
+        if (auto node = _inFlight.extract(job.flightKey)) {
+            followers = std::move(node.mapped());
+        }
+    }
+
+    for (auto& follower : followers) {
+        if (error) {
+            fail(*follower, error);
+        } else {
+            deliver(*follower, response);
+        }
+    }
+    if (error) {
+        fail(job, std::move(error));
+    } else {
+        deliver(job, std::move(response));
+    }
+}
+
+// Whatever escapes here would end the event loop thread and the process
+// with it. A failure before onResponse fails the job; once onResponse has
+// been entered the job is answered, and onError must not follow.
+void MultiSession::deliver(Job& job, Response response)
+{
+    // an error status keeps its body in contents, as a transfer does
+    bool toSink = job.sink && response.code < 400;
+    try {
+        if (toSink && !job.streamed) {
+            feedSink(*job.sink, response.contents);
+        }
+        if (job.cassette) {
+            job.cassette->record(job.cassetteKey, response);
+        }
+    } catch (...) {
+        fail(job, std::current_exception());
+        return;
+    }
+
+    if (toSink) {
+        recycle(std::move(response));
+        response.contents.clear();
+    }
+    try {
+        job.onResponse(std::move(response));
+    } catch (...) {
+        // nobody is left to report this to
+    }
+}
+
+void MultiSession::fail(Job& job, std::exception_ptr error)
+{
+    try {
+        job.onError(std::move(error));
+    } catch (...) {
+        // nobody is left to report this to
+    }
+}
+
+// callbacks never run inside submit(), where the caller may hold a lock
+// they take
+void MultiSession::failLater(
+    std::unique_ptr<Job> job, std::exception_ptr error)
+{
+    {
+        auto lock = std::lock_guard{_mutex};
+        _ready.push_back(Ready{
+            .due = Clock::now(),
+            .job = std::move(job),
+            .response = {},
+            .error = std::move(error),
+        });
+    }
+    _multi.wakeup();
+}
+
+} // namespace http
\ No newline at end of file
@@ -0,0 +1,18 @@
+#include <http/pages.hpp>
+
+namespace http {
+
+Page<nlohmann::json> jsonPage(std::string_view body)
+{
+    auto json = nlohmann::json::parse(body);
+    auto page = Page<nlohmann::json>{
+        .items = {},
+        .total = json["meta"]["total"].get<size_t>(),
+    };
+    for (auto& item : json["data"]) {
+        page.items.push_back(std::move(item));
+    }
+    return page;
+}
+
+} // namespace http
\ No newline at end of file
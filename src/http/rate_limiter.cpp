@@ -0,0 +1,136 @@
+#include <http/rate_limiter.hpp>
+
+#include <algorithm>
+#include <charconv>
+#include <optional>
+#include <string_view>
+#include <utility>
+
+namespace http {
+
+namespace {
+
+std::optional<double> numberHeader(
+    const Response& response, std::string_view name)
+{
+    auto header = response.header(name);
+    if (!header) {
+        return std::nullopt;
+    }
+
+    auto value = 0.0;
+    auto [ptr, ec] = std::from_chars(
+        header->data(), header->data() + header->size(), value);
+    if (ec != std::errc{}) {
+        return std::nullopt;
+    }
+    return value;
+}
+
+} // namespace
+
+RateLimiter::RateLimiter(double ratePerSecond, double burst)
+    : _rate(ratePerSecond)
+    , _burst(burst)
+    , _tokens(burst)
+    , _lastRefill(Clock::now())
+{ }
+
+void RateLimiter::acquire(Priority priority)
+{
+    auto lock = std::unique_lock{_mutex};
+    auto index = std::to_underlying(priority);
+    _waiting.at(index)++;
+
+    for (;;) {
+        auto now = Clock::now();
+        refill(now);
+        if (mayTake(priority, now)) {
+            break;
+        }
+        _tokenReleased.wait_until(lock, nextAvailableLocked());
+    }
+
+    _tokens -= 1.0;
+    _waiting.at(index)--;
+    _tokenReleased.notify_all();
+}
+
+bool RateLimiter::tryAcquire(Priority priority)
+{
+    auto lock = std::lock_guard{_mutex};
+    auto now = Clock::now();
+    refill(now);
+    if (!mayTake(priority, now)) {
+        return false;
+    }
+    _tokens -= 1.0;
+    return true;
+}
+
+RateLimiter::Clock::time_point RateLimiter::nextAvailable() const
+{
+    auto lock = std::lock_guard{_mutex};
+    return nextAvailableLocked();
+}
+
+void RateLimiter::update(const Response& response)
+{
+    auto lock = std::lock_guard{_mutex};
+    auto now = Clock::now();
+    refill(now);
+
+    if (auto rate = numberHeader(response, "x-ratelimit-limit-per-second");
+            rate && *rate > 0) {
+        _rate = *rate;
+    }
+    if (auto burst = numberHeader(response, "x-ratelimit-limit-burst");
+            burst && *burst > 0) {
+        _burst = *burst;
+    }
+    if (auto remaining = numberHeader(response, "x-ratelimit-remaining")) {
+        _tokens = std::min(_tokens, *remaining);
+    }
+    _tokens = std::min(_tokens, _burst);
+
+    if (response.code == 429) {
+        _tokens = std::min(_tokens, 0.0);
+        auto retryAfter = numberHeader(response, "retry-after")
+            .value_or(1.0 / _rate);
+        _pausedUntil = std::max(
+            _pausedUntil,
+            now + std::chrono::duration_cast<Clock::duration>(
+                std::chrono::duration<double>{retryAfter}));
+    }
+
+    _tokenReleased.notify_all();
+}
+
+void RateLimiter::refill(Clock::time_point now)
+{
+    auto elapsed = std::chrono::duration<double>{now - _lastRefill}.count();
+    _tokens = std::min(_burst, _tokens + elapsed * _rate);
+    _lastRefill = now;
+}
+
+bool RateLimiter::mayTake(Priority priority, Clock::time_point now) const
+{
+    for (auto p = 0; p < std::to_underlying(priority); p++) {
+        if (_waiting.at(p) > 0) {
+            return false;
+        }
+    }
+    return now >= _pausedUntil && _tokens >= 1.0;
+}
+
+RateLimiter::Clock::time_point RateLimiter::nextAvailableLocked() const
+{
+    auto refillTime = _lastRefill;
+    if (_tokens < 1.0) {
+        refillTime += std::chrono::duration_cast<Clock::duration>(
+            std::chrono::duration<double>{(1.0 - _tokens) / _rate});
+    }
+    return std::max(refillTime, _pausedUntil);
+}
+
+} // namespace http
\ No newline at end of file
@@ -0,0 +1,72 @@
+#include <http/retry.hpp>
+
+#include <algorithm>
+#include <charconv>
+#include <random>
+
+namespace http {
+
+bool RetryPolicy::isRetryable(const Request& request) const
+{
+    return maxAttempts > 1 && effectiveMethod(request) == Method::GET;
+}
+
+bool RetryPolicy::isTransient(CURLcode code) const
+{
+    switch (code) {
+        case CURLE_COULDNT_RESOLVE_HOST:
+        case CURLE_COULDNT_CONNECT:
+        case CURLE_PARTIAL_FILE:
+        case CURLE_OPERATION_TIMEDOUT:
+        case CURLE_SSL_CONNECT_ERROR:
+        case CURLE_GOT_NOTHING:
+        case CURLE_SEND_ERROR:
+        case CURLE_RECV_ERROR:
+        case CURLE_HTTP2:
+        case CURLE_HTTP2_STREAM:
+            return true;
+        default:
+            return false;
+    }
+}
+
+bool RetryPolicy::isTransient(const Response& response) const
+{
+    return response.code == 429 ||
+        response.code == 500 ||
+        response.code == 502 ||
+        response.code == 503 ||
+        response.code == 504;
+}
+
+std::chrono::milliseconds RetryPolicy::delay(
+    int attempt, const Response* response) const
+{
+    // "equal jitter": half of the exponential step is fixed, the other half
+    // random, so that clients failing together do not retry together
+    auto step = baseDelay * (int64_t{1} << std::clamp(attempt - 1, 0, 20));
+    auto ceiling = std::min<std::chrono::milliseconds>(step, maxDelay);
+
+    thread_local auto random = std::minstd_rand{std::random_device{}()};
+    auto jitter = std::uniform_int_distribution<int64_t>{
+        0, ceiling.count() / 2}(random);
+    auto result = ceiling / 2 + std::chrono::milliseconds{jitter};
+
+    if (auto header = response ?
+            response->header("retry-after") : std::nullopt) {
+        // SpaceTraders sends seconds, possibly fractional; HTTP dates are
+        // left to the backoff
+        auto seconds = 0.0;
+        auto [ptr, ec] = std::from_chars(
+            header->data(), header->data() + header->size(), seconds);
+        if (ec == std::errc{} && seconds > 0) {
+            result = std::max(
+                result,
+                std::chrono::ceil<std::chrono::milliseconds>(
+                    std::chrono::duration<double>{seconds}));
+        }
+    }
+    return result;
+}
+
+} // namespace http
\ No newline at end of file
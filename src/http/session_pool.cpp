@@ -0,0 +1,122 @@
+#include <http/session_pool.hpp>
+
+#include <atomic>
+#include <utility>
+
+namespace http {
+
+namespace {
+
+std::atomic<uint64_t> nextPoolId = 0;
+
+} // namespace
+
+struct SessionPool::Slot {
+    explicit Slot(const Session& prototype)
+        : thread(std::this_thread::get_id())
+        , session(prototype)
+        , created(Clock::now())
+    { }
+
+    const std::thread::id thread;
+    Session session;
+    const Clock::time_point created;
+    std::atomic<uint64_t> requests = 0;
+    std::atomic<int64_t> busyMicroseconds = 0;
+};
+
+double SessionPool::ThreadStats::utilization() const
+{
+    if (lifetime.count() <= 0) {
+        return 0.0;
+    }
+    return static_cast<double>(busy.count()) /
+        static_cast<double>(lifetime.count());
+}
+
+SessionPool::SessionPool()
+    : _id(nextPoolId.fetch_add(1, std::memory_order_relaxed))
+{
+    _prototype.useShare(_share);
+}
+
+SessionPool::~SessionPool() = default;
+
+Session& SessionPool::prototype()
+{
+    return _prototype;
+}
+
+Response SessionPool::operator()(Request request)
+{
+    auto& slot = this->slot();
+    auto start = Clock::now();
+    auto account = [&slot, start] {
+        auto busy = std::chrono::duration_cast<std::chrono::microseconds>(
+            Clock::now() - start);
+        slot.busyMicroseconds.fetch_add(
+            busy.count(), std::memory_order_relaxed);
+        slot.requests.fetch_add(1, std::memory_order_relaxed);
+    };
+
+    try {
+        auto response = slot.session(std::move(request));
+        account();
+        return response;
+    } catch (...) {
+        account();
+        throw;
+    }
+}
+
+void SessionPool::recycle(Response&& response)
+{
+    slot().session.recycle(std::move(response));
+}
+
+Session& SessionPool::session()
+{
+    return slot().session;
+}
+
+std::vector<SessionPool::ThreadStats> SessionPool::stats() const
+{
+    auto now = Clock::now();
+    auto result = std::vector<ThreadStats>{};
+    auto lock = std::lock_guard{_mutex};
+    for (const auto& slot : _slots) {
+        result.push_back(ThreadStats{
+            .thread = slot->thread,
+            .requests = slot->requests.load(std::memory_order_relaxed),
+            .busy = std::chrono::microseconds{
+                slot->busyMicroseconds.load(std::memory_order_relaxed)},
+            .lifetime = std::chrono::duration_cast<std::chrono::microseconds>(
+                now - slot->created),
+        });
+    }
+    return result;
+}
+
+Share::Stats SessionPool::shareStats() const
+{
+    return _share.stats();
+}
+
+SessionPool::Slot& SessionPool::slot()
+{
+    // each thread remembers its slot in every pool it has used; pool ids
+    // are never reused, so entries left by a destroyed pool never match
+    thread_local auto known = std::vector<std::pair<uint64_t, Slot*>>{};
+    for (auto [id, slot] : known) {
+        if (id == _id) {
+            return *slot;
+        }
+    }
+
+    auto lock = std::lock_guard{_mutex};
+    auto& slot = *_slots.emplace_back(std::make_unique<Slot>(_prototype));
+    known.emplace_back(_id, &slot);
+    return slot;
+}
+
+} // namespace http
\ No newline at end of file
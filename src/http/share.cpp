@@ -0,0 +1,88 @@
+#include <http/share.hpp>
+
+namespace http {
+
+namespace {
+
+void checkShare(CURLSHcode code)
+{
+    if (code != CURLSHE_OK) {
+        throw e::Error{} << "CURL share error: " << curl_share_strerror(code);
+    }
+}
+
+} // namespace
+
+double Share::Stats::reuseRate() const
+{
+    if (transfers == 0) {
+        return 0.0;
+    }
+    return static_cast<double>(reusedConnections) /
+        static_cast<double>(transfers);
+}
+
+Share::Share(unsigned data)
+{
+    _ptr.reset(checkCurl(curl_share_init()));
+
+    checkShare(curl_share_setopt(_ptr.get(), CURLSHOPT_LOCKFUNC, lock));
+    checkShare(curl_share_setopt(_ptr.get(), CURLSHOPT_UNLOCKFUNC, unlock));
+    checkShare(curl_share_setopt(_ptr.get(), CURLSHOPT_USERDATA, this));
+
+    if (data & Dns) {
+        checkShare(curl_share_setopt(
+            _ptr.get(), CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS));
+    }
+    if (data & TlsSessions) {
+        checkShare(curl_share_setopt(
+            _ptr.get(), CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION));
+    }
+    if (data & Connections) {
+        checkShare(curl_share_setopt(
+            _ptr.get(), CURLSHOPT_SHARE, CURL_LOCK_DATA_CONNECT));
+    }
+}
+
+Share& Share::global()
+{
+    static auto share = Share{};
+    return share;
+}
+
+CURLSH* Share::ptr()
+{
+    return _ptr.get();
+}
+
+void Share::record(Handle& handle)
+{
+    auto connects = handle.getinfo<long>(CURLINFO_NUM_CONNECTS);
+    _transfers.fetch_add(1, std::memory_order_relaxed);
+    if (connects == 0) {
+        _reusedConnections.fetch_add(1, std::memory_order_relaxed);
+    } else {
+        _newConnections.fetch_add(connects, std::memory_order_relaxed);
+    }
+}
+
+Share::Stats Share::stats() const
+{
+    return Stats{
+        .transfers = _transfers.load(std::memory_order_relaxed),
+        .reusedConnections = _reusedConnections.load(std::memory_order_relaxed),
+        .newConnections = _newConnections.load(std::memory_order_relaxed),
+    };
+}
+
+void Share::lock(CURL*, curl_lock_data data, curl_lock_access, void* share)
+{
+    static_cast<Share*>(share)->_mutexes.at(data).lock();
+}
+
+void Share::unlock(CURL*, curl_lock_data data, void* share)
+{
+    static_cast<Share*>(share)->_mutexes.at(data).unlock();
+}
+
+} // namespace http
\ No newline at end of file
@@ -0,0 +1,68 @@
+#include "storage.hpp"
+
+#include <cstddef>
+#include <ios>
+
+namespace http {
+
+namespace {
+
+constexpr auto maxStoredString = size_t{1} << 32;
+
+} // namespace
+
+uint64_t fnv1a(std::string_view string)
+{
+    auto hash = uint64_t{14695981039346656037ull};
+    for (char c : string) {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+void writeString(std::ostream& output, std::string_view string)
+{
+    output << string.size() << ' ';
+    output.write(string.data(), static_cast<std::streamsize>(string.size()));
+    output << '\n';
+}
+
+std::string readString(std::istream& input)
+{
+    auto size = size_t{0};
+    input >> size;
+    input.get();
+    if (!input || size > maxStoredString) {
+        input.setstate(std::ios::failbit);
+        return {};
+    }
+    auto string = std::string(size, '\0');
+    input.read(string.data(), static_cast<std::streamsize>(size));
+    input.get();
+    return string;
+}
+
+void writeHeaders(std::ostream& output, const Headers& headers)
+{
+    output << headers.size() << '\n';
+    for (const auto& [name, value] : headers) {
+        writeString(output, name);
+        writeString(output, value);
+    }
+}
+
+Headers readHeaders(std::istream& input)
+{
+    auto headers = Headers{};
+    auto count = size_t{0};
+    input >> count;
+    input.get();
+    for (size_t i = 0; i < count && input; i++) {
+        auto name = readString(input);
+        headers.add(name, readString(input));
+    }
+    return headers;
+}
+
+} // namespace http
\ No newline at end of file
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <http/headers.hpp>
+
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <string_view>
+
+namespace http {
+
+uint64_t fnv1a(std::string_view string);
+
+// Length-prefixed fields shared by the on-disk cache and cassettes. Reads
+// set the stream's failbit on malformed input instead of throwing.
+void writeString(std::ostream& output, std::string_view string);
+std::string readString(std::istream& input);
+
+void writeHeaders(std::ostream& output, const Headers& headers);
+Headers readHeaders(std::istream& input);
+
+} // namespace http
\ No newline at end of file
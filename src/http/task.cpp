@@ -0,0 +1,124 @@
+#include <http/task.hpp>
+
+namespace http {
+
+struct Executor::Detached {
+    struct promise_type {
+        Detached get_return_object() noexcept
+        {
+            return Detached{
+                std::coroutine_handle<promise_type>::from_promise(*this)};
+        }
+
+        std::suspend_always initial_suspend() const noexcept
+        {
+            return {};
+        }
+
+        std::suspend_never final_suspend() const noexcept
+        {
+            return {};
+        }
+
+        void return_void() const noexcept { }
+
+        void unhandled_exception() const noexcept
+        {
+            std::terminate();
+        }
+    };
+
+    std::coroutine_handle<promise_type> handle;
+};
+
+void Executor::spawn(Task<void> task)
+{
+    {
+        auto lock = std::lock_guard{_mutex};
+        _active++;
+    }
+    post(launch(std::move(task)).handle);
+}
+
+void Executor::post(std::coroutine_handle<> handle)
+{
+    {
+        auto lock = std::lock_guard{_mutex};
+        _ready.push_back(handle);
+    }
+    _wake.notify_all();
+}
+
+size_t Executor::poll()
+{
+    auto ready = std::deque<std::coroutine_handle<>>{};
+    {
+        auto lock = std::lock_guard{_mutex};
+        std::swap(ready, _ready);
+    }
+
+    // coroutines posted while these run wait for the next poll, so a chain
+    // that completes synchronously cannot starve the caller's loop
+    for (auto handle : ready) {
+        handle.resume();
+    }
+
+    auto error = std::exception_ptr{};
+    {
+        auto lock = std::lock_guard{_mutex};
+        if (!_errors.empty()) {
+            error = std::move(_errors.front());
+            _errors.pop_front();
+        }
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
+    return ready.size();
+}
+
+void Executor::run()
+{
+    for (;;) {
+        poll();
+
+        auto lock = std::unique_lock{_mutex};
+        _wake.wait(lock, [this] {
+            return !_ready.empty() || !_errors.empty() || _active == 0;
+        });
+        if (_ready.empty() && _errors.empty() && _active == 0) {
+            return;
+        }
+    }
+}
+
+size_t Executor::active() const
+{
+    auto lock = std::lock_guard{_mutex};
+    return _active;
+}
+
+Executor::Detached Executor::launch(Task<void> task)
+{
+    auto error = std::exception_ptr{};
+    try {
+        co_await std::move(task);
+    } catch (...) {
+        error = std::current_exception();
+    }
+    finished(std::move(error));
+}
+
+void Executor::finished(std::exception_ptr error)
+{
+    {
+        auto lock = std::lock_guard{_mutex};
+        _active--;
+        if (error) {
+            _errors.push_back(std::move(error));
+        }
+    }
+    _wake.notify_all();
+}
+
+} // namespace http
\ No newline at end of file
@@ -0,0 +1,248 @@
+#include "transfer.hpp"
+
+#include <algorithm>
+#include <format>
+#include <utility>
+
+namespace http {
+
+namespace {
+
+size_t writeDataCallback(
+    char* buffer, size_t, size_t nmemb, ResponseBody* body)
+{
+    try {
+        if (!body->reserved) {
+            // an error page is not what the sink is waiting for
+            auto code = body->handle->getinfo<long>(CURLINFO_RESPONSE_CODE);
+            if (code >= 400) {
+                body->sink = nullptr;
+            }
+            // Content-Length counts encoded bytes, and an encoded body is
+            // written here decoded: its decoded size is unknown up front
+            auto contentLength = body->handle->getinfo<curl_off_t>(
+                CURLINFO_CONTENT_LENGTH_DOWNLOAD_T);
+            bool encoded = body->headers->contains("Content-Encoding");
+            if (contentLength > 0 && !encoded) {
+                if (body->sink) {
+                    body->sink->expect(static_cast<size_t>(contentLength));
+                }
+                if (!body->sink || body->keep) {
+                    body->data.reserve(static_cast<size_t>(contentLength));
+                }
+            }
+            body->reserved = true;
+        }
+
+        body->decodedSize += static_cast<int64_t>(nmemb);
+        if (body->sink) {
+            body->sinkWritten = true;
+            body->sink->write(std::string_view{buffer, nmemb});
+        }
+        if (!body->sink || body->keep) {
+            body->data.append(buffer, nmemb);
+        }
+        return nmemb;
+    } catch (...) {
+        body->error = std::current_exception();
+        return 0;
+    }
+}
+
+size_t writeHeadersCallback(
+    char* buffer, size_t, size_t nitems, Headers* headers)
+{
+    auto string = std::string_view{buffer, nitems};
+
+    // a new status line starts the headers of a redirected or 1xx response
+    if (string.starts_with("HTTP/")) {
+        headers->clear();
+        return nitems;
+    }
+
+    size_t separator = string.find(':');
+    if (separator == string.npos) {
+        return nitems;
+    }
+
+    try {
+        headers->add(string.substr(0, separator), string.substr(separator + 1));
+    } catch (...) {
+        return 0;
+    }
+    return nitems;
+}
+
+void polishRequestInPlace(Request& request)
+{
+    const bool hasData = !request.data.empty();
+    const bool hasJson = !request.json.empty();
+    const bool hasBody = !request.body.empty();
+
+    if (hasData + hasJson + hasBody > 1) {
+        throw e::Error{} <<
+            "only one of .data, .json and .body can be set in http::Request";
+    }
+
+    request.method = effectiveMethod(request);
+
+    if (!request.headers.contains("Content-Type")) {
+        if (hasJson) {
+            request.headers.emplace("Content-Type", "application/json");
+        }
+    }
+}
+
+} // namespace
+
+void feedSink(Sink& sink, std::string_view body)
+{
+    sink.expect(body.size());
+    if (!body.empty()) {
+        sink.write(body);
+    }
+    sink.finish();
+}
+
+void setupHandle(Handle& handle)
+{
+    handle.setopt(CURLOPT_FOLLOWLOCATION, 1);
+    handle.setopt(CURLOPT_WRITEFUNCTION, writeDataCallback);
+    handle.setopt(CURLOPT_HEADERFUNCTION, writeHeadersCallback);
+
+    // an empty string offers every encoding libcurl was built with, and
+    // bodies reach the write callback (and any Sink) already decoded
+    handle.setopt(CURLOPT_ACCEPT_ENCODING, "");
+}
+
+Transfer::Transfer(
+        Handle& handle,
+        Request request,
+        std::string buffer,
+        const Defaults* defaults,
+        bool keepBody)
+    : _handle(handle)
+    , _request(std::move(request))
+    , _body{
+        .handle = &handle,
+        .headers = &_responseHeaders,
+        .sink = _request.sink,
+        .keep = keepBody,
+        .data = std::move(buffer),
+    }
+{
+    _body.data.clear();
+
+    polishRequestInPlace(_request);
+
+    if (_request.method == Method::POST) {
+        // libcurl reads the body from wherever it already is: the request's
+        // own string, the caller's span, or the one serialization of .json
+        auto upload = std::string_view{""};
+        if (!_request.data.empty()) {
+            upload = _request.data;
+        } else if (!_request.json.empty()) {
+            _json = _request.json.dump();
+            upload = _json;
+        } else if (!_request.body.empty()) {
+            upload = std::string_view{
+                reinterpret_cast<const char*>(_request.body.data()),
+                _request.body.size()};
+        }
+        _handle.setopt(
+            CURLOPT_POSTFIELDSIZE_LARGE,
+            static_cast<curl_off_t>(upload.size()));
+        _handle.setopt(CURLOPT_POSTFIELDS, upload.data());
+    } else {
+        _handle.setopt(CURLOPT_HTTPGET, 1);
+    }
+
+    // libcurl keeps a copy of the URL, so one without params is passed
+    // straight from the request
+    if (_request.params.empty()) {
+        _handle.setopt(CURLOPT_URL, _request.url.c_str());
+    } else {
+        _handle.setopt(
+            CURLOPT_URL, buildUrl(_request.url, _request.params).c_str());
+    }
+
+    for (const auto& [name, value] : _request.headers) {
+        _headers.append(std::format("{}: {}", name, value));
+    }
+    curl_slist* headerList = _headers.ptr();
+    if (defaults) {
+        const auto& defaultHeaders = defaults->headers();
+        bool overrides = std::ranges::any_of(
+            _request.headers, [&defaultHeaders] (const auto& header) {
+                return defaultHeaders.contains(header.first);
+            });
+
+        // the shared default list can only be chained as a whole; the rare
+        // request that overrides one of its headers gets a list of its own
+        if (overrides) {
+            for (const auto& [name, value] : defaultHeaders) {
+                if (!_request.headers.contains(name)) {
+                    _headers.append(std::format("{}: {}", name, value));
+                }
+            }
+        } else if (headerList) {
+            _headers.chain(defaults->headerList());
+        } else {
+            headerList = defaults->headerList();
+        }
+    }
+    _handle.setopt(CURLOPT_HTTPHEADER, headerList);
+
+    _handle.setopt(CURLOPT_WRITEDATA, &_body);
+    _handle.setopt(CURLOPT_HEADERDATA, &_responseHeaders);
+}
+
+const Request& Transfer::request() const
+{
+    return _request;
+}
+
+bool Transfer::wroteToSink() const
+{
+    return _body.sinkWritten;
+}
+
+Response Transfer::finish(CURLcode code)
+{
+    if (_body.error) {
+        std::rethrow_exception(_body.error);
+    }
+    checkCurl(code);
+    if (_body.sink) {
+        _body.sink->finish();
+    }
+
+    auto time = [this] (CURLINFO info) {
+        return std::chrono::microseconds{_handle.getinfo<curl_off_t>(info)};
+    };
+
+    return Response{
+        .code = _handle.getinfo<long>(CURLINFO_RESPONSE_CODE),
+        .headers = std::move(_responseHeaders),
+        .contents = std::move(_body.data),
+        .bodySize = {
+            .wire = _handle.getinfo<curl_off_t>(CURLINFO_SIZE_DOWNLOAD_T),
+            .decoded = _body.decodedSize,
+            .sent = _handle.getinfo<curl_off_t>(CURLINFO_SIZE_UPLOAD_T),
+        },
+        .timings = {
+            .nameLookup = time(CURLINFO_NAMELOOKUP_TIME_T),
+            .connect = time(CURLINFO_CONNECT_TIME_T),
+            .appConnect = time(CURLINFO_APPCONNECT_TIME_T),
+            .startTransfer = time(CURLINFO_STARTTRANSFER_TIME_T),
+            .total = time(CURLINFO_TOTAL_TIME_T),
+        },
+    };
+}
+
+std::string Transfer::releaseBuffer()
+{
+    return std::move(_body.data);
+}
+
+} // namespace http
\ No newline at end of file
@@ -0,0 +1,63 @@
+#pragma once
+
+#include "http.hpp"
+
+#include <http/defaults.hpp>
+
+#include <cstdint>
+#include <exception>
+#include <string>
+#include <string_view>
+
+namespace http {
+
+void setupHandle(Handle& handle);
+
+// Hands a body that did not come from a transfer, such as a cache hit, to
+// a sink as if it had just been downloaded.
+void feedSink(Sink& sink, std::string_view body);
+
+struct ResponseBody {
+    Handle* handle = nullptr;
+    const Headers* headers = nullptr;
+    Sink* sink = nullptr;
+    // a body streamed into the sink is also kept in data, for a cache
+    bool keep = false;
+    bool sinkWritten = false;
+    std::string data;
+    bool reserved = false;
+    int64_t decodedSize = 0;
+    std::exception_ptr error;
+};
+
+class Transfer {
+public:
+    Transfer(
+        Handle& handle,
+        Request request,
+        std::string buffer = {},
+        const Defaults* defaults = nullptr,
+        bool keepBody = false);
+
+    Transfer(const Transfer&) = delete;
+    Transfer(Transfer&&) = delete;
+    Transfer& operator=(const Transfer&) = delete;
+    Transfer& operator=(Transfer&&) = delete;
+
+    const Request& request() const;
+    bool wroteToSink() const;
+    Response finish(CURLcode code);
+    // the body buffer of an attempt that is given up instead of finished,
+    // for the buffer pool
+    std::string releaseBuffer();
+
+private:
+    Handle& _handle;
+    Request _request;
+    StringList _headers;
+    std::string _json;
+    ResponseBody _body;
+    Headers _responseHeaders;
+};
+
+} // namespace http
\ No newline at end of file
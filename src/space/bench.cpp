@@ -0,0 +1,99 @@
+#include "space.hpp"
+
+#include <error.hpp>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <format>
+#include <iostream>
+#include <optional>
+#include <regex>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// Times symbol parsing against the std::regex it replaced, over waypoint
+// symbols shaped like the game's ("X1-DF55-A1"), one in eight malformed.
+
+namespace {
+
+std::optional<space::Waypoint> parseWaypointWithRegex(const std::string& string)
+{
+    static const auto waypointRegex =
+        std::regex{"([A-Z0-9]+)-([A-Z0-9]+)-([A-Z0-9]+)"};
+
+    auto match = std::smatch{};
+    if (std::regex_match(string, match, waypointRegex)) {
+        return space::Waypoint{
+            .sector = match[1],
+            .system = match[2],
+            .point = match[3],
+        };
+    }
+    return std::nullopt;
+}
+
+std::vector<std::string> makeSymbols(size_t count)
+{
+    auto symbols = std::vector<std::string>{};
+    symbols.reserve(count);
+    for (size_t i = 0; i < count; i++) {
+        auto symbol = std::format(
+            "X{}-{}{}{}-{}{}",
+            i % 3 + 1,
+            static_cast<char>('A' + i % 26),
+            static_cast<char>('A' + i / 26 % 26),
+            i % 100,
+            static_cast<char>('A' + i / 7 % 26),
+            i % 20);
+        if (i % 8 == 0) {
+            symbol[1] = 'x';
+        }
+        symbols.push_back(std::move(symbol));
+    }
+    return symbols;
+}
+
+template <class Parse>
+void run(
+    std::string_view name,
+    const std::vector<std::string>& symbols,
+    Parse parse)
+{
+    auto start = std::chrono::steady_clock::now();
+    size_t parsed = 0;
+    for (const auto& symbol : symbols) {
+        parsed += parse(symbol);
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+
+    auto nanoseconds =
+        std::chrono::duration<double, std::nano>{elapsed}.count() /
+        static_cast<double>(symbols.size());
+    std::cout << std::format(
+        "{:<16} {:8.1f} ns/symbol ({} parsed)\n", name, nanoseconds, parsed);
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) try
+{
+    auto count = argc > 1 ? std::stoul(argv[1]) : size_t{200'000};
+    auto symbols = makeSymbols(count);
+
+    run("std::regex", symbols, [] (const std::string& symbol) {
+        return parseWaypointWithRegex(symbol).has_value();
+    });
+    run("parseWaypoint", symbols, [] (const std::string& symbol) {
+        return space::parseWaypoint(symbol).has_value();
+    });
+    run("scanWaypoint", symbols, [] (const std::string& symbol) {
+        return space::scanWaypoint(symbol).has_value();
+    });
+    return EXIT_SUCCESS;
+} catch (...) {
+    e::handleError();
+    return EXIT_FAILURE;
+}
\ No newline at end of file
@@ -0,0 +1,93 @@
+#include <space/endpoints.hpp>
+
+namespace space {
+
+namespace {
+
+std::vector<std::string> symbols(const nlohmann::json& json, const char* key)
+{
+    auto result = std::vector<std::string>{};
+    if (auto it = json.find(key); it != json.end()) {
+        for (const auto& item : *it) {
+            result.push_back(item.at("symbol").get<std::string>());
+        }
+    }
+    return result;
+}
+
+void printList(std::ostream& output, const std::vector<std::string>& list)
+{
+    for (const auto& item : list) {
+        output << " " << item;
+    }
+}
+
+} // namespace
+
+void from_json(const nlohmann::json& json, AgentInfo& agent)
+{
+    agent = AgentInfo{
+        .accountId = json.value("accountId", std::string{}),
+        .symbol = json.at("symbol").get<std::string>(),
+        .headquarters = json.at("headquarters").get<std::string>(),
+        .credits = json.at("credits").get<int64_t>(),
+        .startingFaction = json.at("startingFaction").get<std::string>(),
+        .shipCount = json.value("shipCount", 0),
+    };
+}
+
+void from_json(const nlohmann::json& json, Registration& registration)
+{
+    registration = Registration{
+        .token = json.at("token").get<std::string>(),
+        .agent = json.at("agent").get<AgentInfo>(),
+    };
+}
+
+void from_json(const nlohmann::json& json, WaypointInfo& waypoint)
+{
+    waypoint = WaypointInfo{
+        .symbol = json.at("symbol").get<std::string>(),
+        .type = json.at("type").get<std::string>(),
+        .systemSymbol = json.at("systemSymbol").get<std::string>(),
+        .x = json.at("x").get<int>(),
+        .y = json.at("y").get<int>(),
+        .orbitals = symbols(json, "orbitals"),
+        .traits = symbols(json, "traits"),
+        .modifiers = symbols(json, "modifiers"),
+        .isUnderConstruction = json.value("isUnderConstruction", false),
+    };
+}
+
+std::ostream& operator<<(std::ostream& output, const AgentInfo& agent)
+{
+    return output <<
+        agent.symbol << " (" << agent.startingFaction << ")\n" <<
+        "  headquarters: " << agent.headquarters << "\n" <<
+        "  credits: " << agent.credits << "\n" <<
+        "  ships: " << agent.shipCount << "\n";
+}
+
+std::ostream& operator<<(std::ostream& output, const WaypointInfo& waypoint)
+{
+    output << "  * " << waypoint.symbol << ": " << waypoint.type <<
+        " @ " << waypoint.x << ", " << waypoint.y << "\n";
+    if (waypoint.isUnderConstruction) {
+        output << "    under construction\n";
+    }
+    if (!waypoint.modifiers.empty()) {
+        output << "    modifiers:";
+        printList(output, waypoint.modifiers);
+        output << "\n";
+    }
+    if (!waypoint.orbitals.empty()) {
+        output << "    orbitals:";
+        printList(output, waypoint.orbitals);
+        output << "\n";
+    }
+    output << "    traits:";
+    printList(output, waypoint.traits);
+    return output << "\n";
+}
+
+} // namespace space
\ No newline at end of file
@@ -1,14 +1,106 @@
 #pragma once
 
 #include "http.hpp"
+#include "space/endpoints.hpp"
 
+#include <http/cache.hpp>
+#include <http/cassette.hpp>
+#include <http/credentials.hpp>
+#include <http/metrics.hpp>
+#include <http/multi.hpp>
+#include <http/rate_limiter.hpp>
+#include <http/retry.hpp>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
 #include <optional>
 #include <ostream>
 #include <string>
 #include <string_view>
+#include <vector>
 
 namespace space {
 
+// Views of the dash-separated parts of a symbol such as "X1-DF55-A1"
+struct SystemSymbol {
+    std::string_view sector;
+    std::string_view system;
+};
+
+struct WaypointSymbol {
+    std::string_view sector;
+    std::string_view system;
+    std::string_view point;
+};
+
+namespace detail {
+
+// Splits `string` into exactly N non-empty runs of [A-Z0-9] separated by
+// single dashes, in one pass and without allocating
+template <size_t N>
+constexpr std::optional<std::array<std::string_view, N>> splitSymbol(
+    std::string_view string)
+{
+    auto parts = std::array<std::string_view, N>{};
+    size_t part = 0;
+    size_t start = 0;
+    for (size_t i = 0; i < string.size(); i++) {
+        char c = string[i];
+        if (c == '-') {
+            if (i == start || part + 1 == N) {
+                return std::nullopt;
+            }
+            parts[part++] = string.substr(start, i - start);
+            start = i + 1;
+        } else if (!((c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9'))) {
+            return std::nullopt;
+        }
+    }
+    if (start == string.size() || part + 1 != N) {
+        return std::nullopt;
+    }
+    parts[part] = string.substr(start);
+    return parts;
+}
+
+} // namespace detail
+
+constexpr std::optional<SystemSymbol> scanSystem(std::string_view string)
+{
+    if (auto parts = detail::splitSymbol<2>(string)) {
+        return SystemSymbol{(*parts)[0], (*parts)[1]};
+    }
+    return std::nullopt;
+}
+
+constexpr std::optional<WaypointSymbol> scanWaypoint(std::string_view string)
+{
+    if (auto parts = detail::splitSymbol<3>(string)) {
+        return WaypointSymbol{(*parts)[0], (*parts)[1], (*parts)[2]};
+    }
+    return std::nullopt;
+}
+
+// Symbols written in the source, checked while compiling:
+//     constexpr auto headquarters = waypointLiteral("X1-DF55-A1");
+consteval SystemSymbol systemLiteral(std::string_view string)
+{
+    if (auto symbol = scanSystem(string)) {
+        return *symbol;
+    }
+    throw "not a system symbol";
+}
+
+consteval WaypointSymbol waypointLiteral(std::string_view string)
+{
+    if (auto symbol = scanWaypoint(string)) {
+        return *symbol;
+    }
+    throw "not a waypoint symbol";
+}
+
 struct System {
     std::string fullName() const;
 
@@ -17,7 +109,7 @@ struct System {
 };
 
 std::ostream& operator<<(std::ostream& output, const System& system);
-std::optional<System> parseSystem(const std::string& string);
+std::optional<System> parseSystem(std::string_view string);
 
 struct Waypoint {
     std::string fullSystemName() const;
@@ -29,21 +121,34 @@ struct Waypoint {
 };
 
 std::ostream& operator<<(std::ostream& output, const Waypoint& waypoint);
-std::optional<Waypoint> parseWaypoint(const std::string& string);
+std::optional<Waypoint> parseWaypoint(std::string_view string);
 
 class API {
 public:
-    [[nodiscard]] std::string registerNewAgent(
+    explicit API(http::Cassette* cassette = nullptr);
+
+    [[nodiscard]] Registration registerNewAgent(
         std::string_view symbol, std::string_view faction = "COSMIC");
 
-    void agentInfo();
+    AgentInfo agentInfo();
+
+    WaypointInfo info(const Waypoint& waypoint);
+    std::vector<WaypointInfo> info(const System& system);
+
+    // downloads every system of the galaxy into `path`; returns its size
+    uint64_t exportSystems(const std::filesystem::path& path);
 
-    void info(const Waypoint& waypoint);
-    void info(const System& system);
+    const http::Metrics& metrics() const;
 
 private:
     http::Init _httpInit;
+    http::RateLimiter _rateLimiter;
+    http::Cache _cache;
+    http::Metrics _metrics;
+    http::RetryPolicy _retryPolicy{.hedge = true};
+    http::Credentials _credentials;
     http::Session _session;
+    http::MultiSession _multi;
 };
 
 } // namespace
\ No newline at end of file
@@ -0,0 +1,213 @@
+#pragma once
+
+#include <http.hpp>
+#include <http/pages.hpp>
+
+#include <error.hpp>
+
+#include <nlohmann/json.hpp>
+
+#include <algorithm>
+#include <array>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace space {
+
+struct AgentInfo {
+    std::string accountId;
+    std::string symbol;
+    std::string headquarters;
+    int64_t credits = 0;
+    std::string startingFaction;
+    int shipCount = 0;
+};
+
+struct Registration {
+    std::string token;
+    AgentInfo agent;
+};
+
+struct WaypointInfo {
+    std::string symbol;
+    std::string type;
+    std::string systemSymbol;
+    int x = 0;
+    int y = 0;
+    std::vector<std::string> orbitals;
+    std::vector<std::string> traits;
+    std::vector<std::string> modifiers;
+    bool isUnderConstruction = false;
+};
+
+void from_json(const nlohmann::json& json, AgentInfo& agent);
+void from_json(const nlohmann::json& json, Registration& registration);
+void from_json(const nlohmann::json& json, WaypointInfo& waypoint);
+
+std::ostream& operator<<(std::ostream& output, const AgentInfo& agent);
+std::ostream& operator<<(std::ostream& output, const WaypointInfo& waypoint);
+
+// An endpoint path such as "systems/{}/waypoints", checked and measured at
+// compile time. Every "{}" is replaced by one argument of the request.
+template <size_t N>
+struct PathTemplate {
+    consteval PathTemplate(const char (&string)[N])
+    {
+        std::ranges::copy(string, chars.begin());
+    }
+
+    constexpr std::string_view view() const
+    {
+        return {chars.data(), N - 1};
+    }
+
+    constexpr size_t placeholders() const
+    {
+        size_t count = 0;
+        for (auto i = view().find("{}"); i != std::string_view::npos;
+                i = view().find("{}", i + 2)) {
+            count++;
+        }
+        return count;
+    }
+
+    std::array<char, N> chars{};
+};
+
+// Fixed-size buffer a path is formatted into without touching the heap
+template <size_t Capacity>
+class PathBuffer {
+public:
+    void append(std::string_view string)
+    {
+        if (string.size() > Capacity - _size) {
+            throw e::Error{} << "path does not fit in " << Capacity <<
+                " characters: " << view() << string;
+        }
+        std::ranges::copy(string, _chars.begin() + _size);
+        _size += string.size();
+    }
+
+    std::string_view view() const
+    {
+        return {_chars.data(), _size};
+    }
+
+private:
+    std::array<char, Capacity> _chars;
+    size_t _size = 0;
+};
+
+// Typed access to an endpoint described by E:
+//
+//     struct GetAgent {
+//         static constexpr auto method = http::Method::GET;
+//         static constexpr auto path = PathTemplate{"my/agent"};
+//         using Response = AgentInfo;
+//     };
+//
+// Response is what the "data" member of the reply decodes to, or the type
+// of one item for a paged list.
+template <class E>
+class Endpoint {
+public:
+    using Response = typename E::Response;
+
+    // longest symbol a placeholder may be replaced with
+    static constexpr size_t maxArgumentSize = 64;
+
+    template <std::convertible_to<std::string_view>... Args>
+    static http::Request request(const Args&... args)
+    {
+        static_assert(
+            sizeof...(Args) == E::path.placeholders(),
+            "one argument is needed for every {} in the endpoint path");
+
+        auto buffer = PathBuffer<
+            E::path.view().size() + sizeof...(Args) * maxArgumentSize>{};
+        auto rest = E::path.view();
+        [[maybe_unused]] auto substitute =
+            [&buffer, &rest] (std::string_view argument) {
+                auto placeholder = rest.find("{}");
+                buffer.append(rest.substr(0, placeholder));
+                buffer.append(argument);
+                rest.remove_prefix(placeholder + 2);
+            };
+        (substitute(args), ...);
+        buffer.append(rest);
+
+        return http::Request{
+            .method = E::method,
+            .url = std::string{buffer.view()},
+        };
+    }
+
+    static Response decode(const http::Response& response)
+    {
+        return data(response.code, response.contents)
+            .template get<Response>();
+    }
+
+    static http::Page<Response> decodePage(std::string_view body)
+    {
+        auto json = nlohmann::json::parse(body);
+        return http::Page<Response>{
+            .items = json.at("data").template get<std::vector<Response>>(),
+            .total = json.at("meta").at("total").template get<size_t>(),
+        };
+    }
+
+private:
+    static nlohmann::json data(long code, std::string_view body)
+    {
+        if (code >= 400) {
+            // proxies and gateways answer with HTML or plain text
+            auto json = nlohmann::json::parse(body, nullptr, false);
+            if (!json.is_object() || !json.contains("error") ||
+                    !json["error"].is_object()) {
+                throw e::Error{} << "HTTP " << code << " on " <<
+                    E::path.view() << ": " << body;
+            }
+            const auto& error = json["error"];
+            throw e::Error{} << "SpaceTraders error " <<
+                error.value("code", 0) << " (HTTP " << code << ") on " <<
+                E::path.view() << ": " <<
+                error.value("message", std::string{});
+        }
+        auto json = nlohmann::json::parse(body);
+        return std::move(json.at("data"));
+    }
+};
+
+struct RegisterAgent {
+    static constexpr auto method = http::Method::POST;
+    static constexpr auto path = PathTemplate{"register"};
+    using Response = Registration;
+};
+
+struct GetAgent {
+    static constexpr auto method = http::Method::GET;
+    static constexpr auto path = PathTemplate{"my/agent"};
+    using Response = AgentInfo;
+};
+
+struct GetWaypoint {
+    static constexpr auto method = http::Method::GET;
+    static constexpr auto path =
+        PathTemplate{"systems/{}/waypoints/{}"};
+    using Response = WaypointInfo;
+};
+
+struct ListWaypoints {
+    static constexpr auto method = http::Method::GET;
+    static constexpr auto path = PathTemplate{"systems/{}/waypoints"};
+    using Response = WaypointInfo;
+};
+
+} // namespace space
\ No newline at end of file
@@ -1,10 +1,20 @@
 #include "space.hpp"
 
+#include <http/file_sink.hpp>
+#include <http/pages.hpp>
+
+#include <error.hpp>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstddef>
 #include <cstdlib>
 #include <filesystem>
 #include <format>
-#include <fstream>
-#include <regex>
+#include <string_view>
+#include <type_traits>
+#include <utility>
 
 namespace space {
 
@@ -12,27 +22,63 @@ namespace {
 
 const auto baseUrl = http::URL{"https://api.spacetraders.io/v2"};
 
+// fs::home() is Windows-only, and the space library builds everywhere
 std::filesystem::path home()
 {
 #ifdef _WIN32
-    return std::getenv("HOMEPATH");
+    const char* home = std::getenv("USERPROFILE");
+#else
+    const char* home = std::getenv("HOME");
 #endif
+    if (!home || !*home) {
+        throw e::Error{} << "cannot find the home directory";
+    }
+    return home;
 }
 
-std::string token()
+// a string literal as a template argument, to test the consteval parsers
+template <size_t N>
+struct Text {
+    consteval Text(const char (&string)[N])
+    {
+        std::ranges::copy(string, chars.begin());
+    }
+
+    constexpr std::string_view view() const
+    {
+        return {chars.data(), N - 1};
+    }
+
+    std::array<char, N> chars{};
+};
+
+// a literal the parser rejects is not a constant expression, which fails
+// the requirement instead of the build
+template <Text S>
+concept SystemLiteral = requires
 {
-    auto tokenFile = std::ifstream{home() / ".space_traders_token"};
-    tokenFile.exceptions(std::ios::badbit | std::ios::failbit);
-    auto token = std::string{};
-    tokenFile >> token;
-    tokenFile.close();
-    return token;
-}
+    typename std::bool_constant<(systemLiteral(S.view()), true)>;
+};
 
-std::pair<std::string, std::string> authHeader()
+template <Text S>
+concept WaypointLiteral = requires
 {
-    return {"Authorization", std::format("Bearer {}", token())};
-}
+    typename std::bool_constant<(waypointLiteral(S.view()), true)>;
+};
+
+static_assert(systemLiteral("X1-DF55").system == "DF55");
+static_assert(SystemLiteral<"X1-DF55">);
+static_assert(!SystemLiteral<"X1">);
+static_assert(!SystemLiteral<"X1-DF55-A1">);
+static_assert(!SystemLiteral<"X1--DF55">);
+static_assert(!SystemLiteral<"x1-DF55">);
+
+static_assert(waypointLiteral("X1-DF55-A1").point == "A1");
+static_assert(WaypointLiteral<"X1-DF55-A1">);
+static_assert(!WaypointLiteral<"">);
+static_assert(!WaypointLiteral<"X1-DF55">);
+static_assert(!WaypointLiteral<"X1-DF55-A1-">);
+static_assert(!WaypointLiteral<"X1-DF55-A 1">);
 
 } // namespace
 
@@ -46,15 +92,12 @@ std::ostream& operator<<(std::ostream& output, const System& system)
     return output << system.sector << "-" << system.system;
 }
 
-std::optional<System> parseSystem(const std::string& string)
+std::optional<System> parseSystem(std::string_view string)
 {
-    static const auto systemRegex = std::regex{"([A-Z0-9]+)-([A-Z0-9]+)"};
-
-    auto match = std::smatch{};
-    if (std::regex_match(string, match, systemRegex)) {
+    if (auto symbol = scanSystem(string)) {
         return System{
-            .sector = match[1],
-            .system = match[2],
+            .sector = std::string{symbol->sector},
+            .system = std::string{symbol->system},
         };
     }
     return std::nullopt;
@@ -76,86 +119,108 @@ std::ostream& operator<<(std::ostream& output, const Waypoint& waypoint)
         waypoint.sector << "-" << waypoint.system << "-" << waypoint.point;
 }
 
-std::optional<Waypoint> parseWaypoint(const std::string& string)
+std::optional<Waypoint> parseWaypoint(std::string_view string)
 {
-    static const auto waypointRegex =
-        std::regex{"([A-Z0-9]+)-([A-Z0-9]+)-([A-Z0-9]+)"};
-
-    auto match = std::smatch{};
-    if (std::regex_match(string, match, waypointRegex)) {
+    if (auto symbol = scanWaypoint(string)) {
         return Waypoint{
-            .sector = match[1],
-            .system = match[2],
-            .point = match[3],
+            .sector = std::string{symbol->sector},
+            .system = std::string{symbol->system},
+            .point = std::string{symbol->point},
         };
     }
     return std::nullopt;
 }
 
-std::string API::registerNewAgent(std::string_view symbol, std::string_view faction)
+API::API(http::Cassette* cassette)
+    : _cache(home() / ".space_traders_cache")
+    , _credentials(home() / ".space_traders_token")
 {
-    auto r = _session(http::Request{
-        .url = baseUrl / "register",
-        .json = {
-            {"symbol", symbol},
-            {"faction", faction},
-        },
-    });
-
-    return r.json()["data"]["token"].get<std::string>();
+    // systems and factions do not change; waypoints are only revalidated
+    _cache.policy(baseUrl / "systems", std::chrono::hours{24});
+    _cache.policy(baseUrl / "systems/{}", std::chrono::hours{24});
+    _cache.policy(baseUrl / "factions", std::chrono::hours{24});
+    _cache.policy(baseUrl / "factions/{}", std::chrono::hours{24});
+
+    _session.baseUrl(baseUrl);
+    _multi.baseUrl(baseUrl);
+
+    // agents are registered without a token, so a missing file is fine here
+    _session.useCredentials(_credentials);
+    _multi.useCredentials(_credentials);
+
+    _session.useShare(http::Share::global());
+    _session.useRateLimiter(_rateLimiter);
+    _session.useCache(_cache);
+    _session.useMetrics(_metrics);
+    _session.useRetryPolicy(_retryPolicy);
+    _multi.useShare(http::Share::global());
+    _multi.useRateLimiter(_rateLimiter);
+    _multi.useCache(_cache);
+    _multi.useMetrics(_metrics);
+    _multi.useRetryPolicy(_retryPolicy);
+
+    if (cassette) {
+        _session.useCassette(*cassette);
+        _multi.useCassette(*cassette);
+    }
 }
 
-void API::agentInfo()
+Registration API::registerNewAgent(
+    std::string_view symbol, std::string_view faction)
 {
-    auto r = _session(http::Request{
-        .url = baseUrl / "my/agent",
-        .headers = {authHeader()},
-    });
+    auto request = Endpoint<RegisterAgent>::request();
+    request.json = {
+        {"symbol", symbol},
+        {"faction", faction},
+    };
+    return Endpoint<RegisterAgent>::decode(_session(std::move(request)));
+}
 
-    std::cout << r.json()["data"].dump(4) << "\n";
+AgentInfo API::agentInfo()
+{
+    return Endpoint<GetAgent>::decode(
+        _session(Endpoint<GetAgent>::request()));
 }
 
-void API::info(const Waypoint& waypoint)
+WaypointInfo API::info(const Waypoint& waypoint)
 {
-    auto r = _session(http::Request{
-        .url = baseUrl / "systems" / waypoint.fullSystemName() /
-            "waypoints" / waypoint.fullName(),
-        .headers = {authHeader()},
-    });
+    auto request = Endpoint<GetWaypoint>::request(
+        waypoint.fullSystemName(), waypoint.fullName());
+    return Endpoint<GetWaypoint>::decode(_session(std::move(request)));
+}
 
-    std::cout << r.json()["data"].dump(4) << "\n";
+std::vector<WaypointInfo> API::info(const System& system)
+{
+    auto waypoints = http::PageStream<WaypointInfo>{
+        _multi,
+        Endpoint<ListWaypoints>::request(system.fullName()),
+        Endpoint<ListWaypoints>::decodePage,
+    };
+
+    auto result = std::vector<WaypointInfo>{};
+    for (auto& waypoint : waypoints) {
+        result.push_back(std::move(waypoint));
+    }
+    return result;
 }
 
-void API::info(const System& system)
+uint64_t API::exportSystems(const std::filesystem::path& path)
 {
-    auto r = _session(http::Request{
-        .url = baseUrl / "systems" / system.fullName() / "waypoints",
-        .headers = {authHeader()},
+    auto file = http::FileSink{path};
+    auto response = _session(http::Request{
+        .url = "systems.json",
+        .sink = &file,
     });
-
-    auto data = r.json()["data"];
-
-    for (const auto& object : data) {
-        std::cout << "  * " << object["symbol"].get<std::string>() <<
-            ": " << object["type"].get<std::string>() <<
-            " @ " << object["x"] << ", " << object["y"] << "\n";
-        if (object["isUnderConstruction"]) {
-            std::cout << "under construction\n";
-        }
-        if (const auto& modifiers = object["modifiers"]; !modifiers.empty()) {
-            std::cout << "    modifiers: " << modifiers << "\n";
-        }
-        if (const auto& orbitals = object["orbitals"]; !orbitals.empty()) {
-            std::cout << "    orbitals: " << orbitals << "\n";
-        }
-        std::cout << "    traits:";
-        for (const auto& trait : object["traits"]) {
-            std::cout << " " << trait["symbol"].get<std::string>();
-        }
-        std::cout << "\n";
-
-        std::cout << "\n";
+    if (response.code >= 400) {
+        throw e::Error{} << "HTTP " << response.code << " for systems.json: " <<
+            response.contents;
     }
+    return file.size();
+}
+
+const http::Metrics& API::metrics() const
+{
+    return _metrics;
 }
 
 } // namespace space
\ No newline at end of file
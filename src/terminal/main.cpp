@@ -2,6 +2,8 @@
 
 #include <arg.hpp>
 
+#include <http/cassette.hpp>
+
 #include <nlohmann/json.hpp>
 
 #include <fstream>
@@ -14,7 +16,9 @@ using json = nlohmann::json;
 
 namespace cmd {
 
-void registerNew(const arg::MultiValue<std::string>& args)
+using Args = arg::MultiValue<std::string>;
+
+void registerNew(const Args& args, space::API& api)
 {
     auto parser = arg::Parser{};
     auto symbol = parser.option<std::string>()
@@ -27,40 +31,51 @@ void registerNew(const arg::MultiValue<std::string>& args)
         .help("faction to join, COSMIC is recommended in the tutorial");
     parser.parse(args);
 
-    auto api = space::API{};
-
-    auto token = api.registerNewAgent(*symbol, *faction);
-    std::cout << "your token: [" << token << "]\n" <<
+    auto registration = api.registerNewAgent(*symbol, *faction);
+    std::cout << "your token: [" << registration.token << "]\n" <<
         "save it at ~/.space_traders_token file\n";
 }
 
-void info(const arg::MultiValue<std::string>& args)
+void info(const Args& args, space::API& api)
 {
     auto parser = arg::Parser{};
     auto object = parser.argument<std::string>()
         .help("object to get info for");
     parser.parse(args);
 
-    auto api = space::API{};
-
     if (!object.isSet()) {
-        api.agentInfo();
+        std::cout << api.agentInfo();
         return;
     }
 
-    if (auto waypoint = space::parseWaypoint(object)) {
-        api.info(*waypoint);
+    if (auto waypoint = space::parseWaypoint(*object)) {
+        std::cout << api.info(*waypoint);
         return;
     }
 
-    if (auto system = space::parseSystem(object)) {
-        api.info(*system);
+    if (auto system = space::parseSystem(*object)) {
+        for (const auto& waypoint : api.info(*system)) {
+            std::cout << waypoint << "\n";
+        }
         return;
     }
 
     throw e::Error{} << "unknown object: " << object;
 }
 
+void exportSystems(const Args& args, space::API& api)
+{
+    auto parser = arg::Parser{};
+    auto output = parser.option<std::string>()
+        .keys("-o", "--output")
+        .markRequired()
+        .help("file to write every system of the galaxy to, as JSON");
+    parser.parse(args);
+
+    auto size = api.exportSystems(*output);
+    std::cout << "wrote " << size << " bytes to " << *output << "\n";
+}
+
 } // namespace cmd
 
 int main(int argc, char* argv[]) try
@@ -70,16 +85,44 @@ int main(int argc, char* argv[]) try
         .markRequired()
         .help("command to execute");
     auto sink = arg::multiArgument<std::string>();
+    auto record = arg::option<std::string>()
+        .keys("--record")
+        .metavar("PATH")
+        .help("record the responses of the command to a file");
+    auto replay = arg::option<std::string>()
+        .keys("--replay")
+        .metavar("PATH")
+        .help("answer the command from a recording instead of the server");
+    auto stats = arg::flag()
+        .keys("--stats")
+        .help("print request latencies per endpoint when done");
     arg::helpKeys("-h", "--help");
     arg::parse(argc, argv);
 
-    auto commandMapping = std::map<std::string, void(*)(const arg::MultiValue<std::string>&)>{
-        {"register", cmd::registerNew},
-        {"info", cmd::info},
-    };
+    auto cassette = std::unique_ptr<http::Cassette>{};
+    if (record.isSet() && replay.isSet()) {
+        throw e::Error{} << "--record and --replay are exclusive";
+    } else if (record.isSet()) {
+        cassette = std::make_unique<http::Cassette>(
+            *record, http::Cassette::Mode::Record);
+    } else if (replay.isSet()) {
+        cassette = std::make_unique<http::Cassette>(
+            *replay, http::Cassette::Mode::Replay);
+    }
+
+    auto commandMapping =
+        std::map<std::string, void(*)(const cmd::Args&, space::API&)>{
+            {"register", cmd::registerNew},
+            {"info", cmd::info},
+            {"export", cmd::exportSystems},
+        };
 
     if (auto it = commandMapping.find(command); it != commandMapping.end()) {
-        it->second(sink);
+        auto api = space::API{cassette.get()};
+        it->second(sink, api);
+        if (stats) {
+            api.metrics().dump(std::cerr);
+        }
         return EXIT_SUCCESS;
     }
 